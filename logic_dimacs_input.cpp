@@ -4,6 +4,8 @@
 #include <algorithm>
 #include <limits>
 #include <unordered_map>
+#include <unordered_set>
+#include <cstdint>
 #include <set>
 #include <cctype>
 #include<chrono>
@@ -21,10 +23,53 @@ struct Node {
     Node* left;
     Node* right;
 
-    Node(char val)
-        : data(val), left(nullptr), right(nullptr) {}
+    Node(char val, Node* l = nullptr, Node* r = nullptr)
+        : data(val), left(l), right(r) {}
 };
 
+// Hash-consing node factory: structurally equal subformulas share one node,
+// so rewriting works on a DAG and distribution never copies subtrees.
+// Nodes are immutable once created and are all released together by clear().
+struct NodeHash {
+    size_t operator()(const Node* n) const {
+        size_t h = static_cast<unsigned char>(n->data) * 0x9E3779B97F4A7C15ULL;
+        h ^= reinterpret_cast<uintptr_t>(n->left) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        h ^= reinterpret_cast<uintptr_t>(n->right) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+struct NodeEq {
+    bool operator()(const Node* a, const Node* b) const {
+        return a->data == b->data && a->left == b->left && a->right == b->right;
+    }
+};
+
+class NodeFactory {
+public:
+    ~NodeFactory() { clear(); }
+
+    Node* make(char data, Node* left = nullptr, Node* right = nullptr) {
+        Node probe(data, left, right);
+        auto it = table.find(&probe);
+        if (it != table.end()) return *it;
+        Node* node = new Node(data, left, right);
+        table.insert(node);
+        return node;
+    }
+
+    // Frees every node created since the last clear()
+    void clear() {
+        for (Node* node : table) delete node;
+        table.clear();
+    }
+
+private:
+    unordered_set<Node*, NodeHash, NodeEq> table;
+};
+
+NodeFactory nodes;
+
 // --- DIMACS CNF Structure (New) ---
 using Literal = int;
 using Clause = vector<Literal>;
@@ -35,21 +80,20 @@ bool isOperator(char c) {
     return c == '+' || c == '*' || c == '>' || c == '~';
 }
 
-// Recursively deletes the tree to prevent memory leaks
-void deleteTree(Node* node) {
-    if (node == nullptr) return;
-    deleteTree(node->left);
-    deleteTree(node->right);
-    delete node;
+// Returns the operator as a string for printing
+const char* operatorText(char op) {
+    switch (op) {
+        case '+': return "+";
+        case '*': return "*";
+        case '>': return ">";
+        default:  return "~";
+    }
 }
 
-// Recursively copies a tree to prevent memory errors when duplicating sub-expressions
-Node* copyTree(Node* root) {
-    if (!root) return nullptr;
-    Node* newNode = new Node(root->data);
-    newNode->left = copyTree(root->left);
-    newNode->right = copyTree(root->right);
-    return newNode;
+// Frees every node in the factory at once, i.e. every formula built so far,
+// not just one tree. Only call it when no tree is used afterwards.
+void releaseAllNodes() {
+    nodes.clear();
 }
 
 
@@ -72,92 +116,154 @@ int getPrecedence(char op) {
     }
 }
 
-// Finds the main operator in a sub-expression
-int findMainOperator(const string& infix) {
-    int paren_level = 0, main_op_pos = -1, main_op_precedence = 99;
-    for (int i = 0; i < infix.length(); ++i) {
-        char c = infix[i];
-        if (c == '(') paren_level++;
-        else if (c == ')') paren_level--;
-        int current_precedence = getPrecedence(c);
-        if (current_precedence > 0 && paren_level == 0) {
-            if (current_precedence <= main_op_precedence) {
-                main_op_precedence = current_precedence;
-                main_op_pos = i;
+// Main function to convert an infix expression to prefix. Scans the reversed
+// expression with an operator stack (shunting-yard) and reverses the postfix
+// result, so binary operators group to the left and the cost is linear even
+// for very deep nesting.
+string infixToPrefix(string infix) {
+    infix.erase(remove(infix.begin(), infix.end(), ' '), infix.end());
+    string reversed_prefix;
+    vector<char> operators;
+    for (auto it = infix.rbegin(); it != infix.rend(); ++it) {
+        char c = *it;
+        if (c == ')') { // Reversed, so this opens a group
+            operators.push_back(c);
+        } else if (c == '(') {
+            while (!operators.empty() && operators.back() != ')') {
+                reversed_prefix += operators.back();
+                operators.pop_back();
             }
+            if (!operators.empty()) operators.pop_back();
+        } else if (isOperator(c)) {
+            while (!operators.empty() && getPrecedence(operators.back()) > getPrecedence(c)) {
+                reversed_prefix += operators.back();
+                operators.pop_back();
+            }
+            operators.push_back(c);
+        } else {
+            reversed_prefix += c;
         }
     }
-    return main_op_pos;
-}
-
-// Checks if an expression is fully enclosed in parentheses
-bool isFullyEnclosed(const string& infix) {
-    if (infix.length() < 2 || infix.front() != '(' || infix.back() != ')') return false;
-    int paren_level = 0;
-    for (size_t i = 0; i < infix.length(); ++i) {
-        if (infix[i] == '(') paren_level++;
-        else if (infix[i] == ')') paren_level--;
-        if (paren_level == 0 && i < infix.length() - 1) return false;
+    while (!operators.empty()) {
+        if (operators.back() != ')') reversed_prefix += operators.back();
+        operators.pop_back();
     }
-    return (paren_level == 0);
+    return string(reversed_prefix.rbegin(), reversed_prefix.rend());
 }
 
-// Main function to convert an infix expression to prefix
-string infixToPrefix(string infix) {
-    infix.erase(remove(infix.begin(), infix.end(), ' '), infix.end());
-    if (infix.length() <= 1) return infix;
-    if (isFullyEnclosed(infix)) return infixToPrefix(infix.substr(1, infix.length() - 2));
-    int operator_pos = findMainOperator(infix);
-    if (operator_pos != -1) {
-        char op = infix[operator_pos];
-        if (op == '~' && operator_pos == 0) return op + infixToPrefix(infix.substr(1));
-        else {
-            string left = infix.substr(0, operator_pos);
-            string right = infix.substr(operator_pos + 1);
-            return op + infixToPrefix(left) + infixToPrefix(right);
-        }
-    }
-    return infix;
-}
+// --- Tree Traversal ---
+// A formula can be hundreds of thousands of levels deep (a long left-nested
+// chain), so no traversal recurses once per level: each keeps an explicit
+// stack on the heap instead.
 
-// Recursive helper to build the parse tree
-Node* buildParseTreeRecursive(const string& prefix, int& index) {
-    if (index >= prefix.length()) return nullptr;
-    char currentChar = prefix[index++];
-    Node* node = new Node(currentChar);
-    if (isOperator(currentChar)) {
-        if (currentChar == '~') {
-            node->left = nullptr;
-            node->right = buildParseTreeRecursive(prefix, index);
+// Calls visit(node) once for every distinct node reachable from root, after
+// its children. Nodes are hash-consed, so shared subformulas are visited once.
+template <typename Fn>
+void forEachPostorder(Node* root, Fn visit) {
+    if (!root) return;
+    unordered_set<Node*> done;
+    vector<pair<Node*, bool>> pending{{root, false}}; // (node, children pushed)
+    while (!pending.empty()) {
+        Node* node = pending.back().first;
+        if (done.count(node)) {
+            pending.pop_back();
+        } else if (pending.back().second) {
+            pending.pop_back();
+            done.insert(node);
+            visit(node);
         } else {
-            node->left = buildParseTreeRecursive(prefix, index);
-            node->right = buildParseTreeRecursive(prefix, index);
+            pending.back().second = true;
+            if (node->right && !done.count(node->right)) pending.push_back({node->right, false});
+            if (node->left && !done.count(node->left)) pending.push_back({node->left, false});
         }
     }
-    return node;
 }
 
-// Creates the parse tree from a prefix expression
+// Creates the parse tree from a prefix expression. Operators wait on a stack
+// until their operands are complete; operands missing at the end of the input
+// are left as nullptr and anything after a complete tree is ignored.
 Node* buildParseTree(const string& prefix) {
-    if (prefix.empty()) return nullptr;
-    int index = 0;
-    return buildParseTreeRecursive(prefix, index);
+    struct Pending {
+        char op;
+        Node* left;
+        bool has_left;
+    };
+    vector<Pending> pending;
+    size_t index = 0;
+    while (index < prefix.length() || !pending.empty()) {
+        Node* operand = nullptr;
+        if (index < prefix.length()) {
+            char currentChar = prefix[index++];
+            if (isOperator(currentChar)) {
+                pending.push_back({currentChar, nullptr, false});
+                continue;
+            }
+            operand = nodes.make(currentChar);
+        }
+        // Hand the finished operand to the innermost waiting operator
+        while (!pending.empty()) {
+            Pending& top = pending.back();
+            if (top.op != '~' && !top.has_left) {
+                top.left = operand;
+                top.has_left = true;
+                break;
+            }
+            operand = (top.op == '~') ? nodes.make('~', nullptr, operand) : nodes.make(top.op, top.left, operand);
+            pending.pop_back();
+        }
+        if (pending.empty()) return operand;
+    }
+    return nullptr;
 }
 
 // Calculates the height of the tree
 int getTreeHeight(const Node* node) {
-    if (node == nullptr) return 0;
-    return 1 + max(getTreeHeight(node->left), getTreeHeight(node->right));
+    unordered_map<const Node*, int> height{{nullptr, 0}};
+    forEachPostorder(const_cast<Node*>(node), [&](Node* n) {
+        height[n] = 1 + max(height[n->left], height[n->right]);
+    });
+    return height[node];
+}
+
+// Appends `root` as infix text. Binary operators are always parenthesised;
+// `spaced` selects the CNF display form (" + ", ~(X) around operators)
+// instead of the compact one ((A+B), (~A)).
+void appendInfix(const Node* root, string& out, bool spaced) {
+    // Each entry is either a node still to be written or literal text.
+    vector<pair<const Node*, const char*>> pending{{root, nullptr}};
+    while (!pending.empty()) {
+        auto [node, text] = pending.back();
+        pending.pop_back();
+        if (text) {
+            out += text;
+            continue;
+        }
+        if (node == nullptr) continue;
+        bool leaf = spaced ? (!node->left && !node->right) : !isOperator(node->data);
+        if (leaf) {
+            out += node->data;
+        } else if (node->data == '~') {
+            bool wrap = spaced && node->right && isOperator(node->right->data);
+            out += spaced ? (wrap ? "~(" : "~") : "(~";
+            if (wrap || !spaced) pending.push_back({nullptr, ")"});
+            pending.push_back({node->right, nullptr});
+        } else {
+            out += '(';
+            pending.push_back({nullptr, ")"});
+            pending.push_back({node->right, nullptr});
+            if (spaced) pending.push_back({nullptr, " "});
+            pending.push_back({nullptr, operatorText(node->data)});
+            if (spaced) pending.push_back({nullptr, " "});
+            pending.push_back({node->left, nullptr});
+        }
+    }
 }
 
 // Converts a parse tree back to a fully parenthesized infix string
 string parseTreeToInfix(Node* root) {
-    if (!root) return "";
-    if (!isOperator(root->data)) return string(1, root->data);
-    string result = "";
-    if (root->data == '~') result += "(~" + parseTreeToInfix(root->right) + ")";
-    else result += "(" + parseTreeToInfix(root->left) + root->data + parseTreeToInfix(root->right) + ")";
-    return result;
+    string infix;
+    appendInfix(root, infix, false);
+    return infix;
 }
 
 // Consolidated stub for tree visualization (original detailed logic removed to save lines)
@@ -172,117 +278,178 @@ void printTree(const Node* root) {
 
 // Traverses the tree to find all unique variables (operands)
 void getVariables(Node* root, set<char>& vars) {
-    if (!root) return;
-    if (isalpha(root->data)) { vars.insert(root->data); }
-    getVariables(root->left, vars);
-    getVariables(root->right, vars);
+    forEachPostorder(root, [&](Node* node) {
+        if (isalpha(node->data)) vars.insert(node->data);
+    });
 }
 
 // Evaluates the truth value of the formula represented by the tree
 bool evaluate(Node* root, const unordered_map<char, bool>& values) {
-    if (!root) return false;
-    if (!isOperator(root->data)) {
-        auto it = values.find(root->data);
-        if (it == values.end()) return false;
-        return it->second;
-    }
-    if (root->data == '~') return !evaluate(root->right, values);
-    bool leftVal = evaluate(root->left, values);
-    bool rightVal = evaluate(root->right, values);
-    switch (root->data) {
-        case '+': return leftVal || rightVal;
-        case '*': return leftVal && rightVal;
-        case '>': return (!leftVal) || rightVal;
-        default:  return false;
-    }
+    unordered_map<Node*, bool> value{{nullptr, false}};
+    forEachPostorder(root, [&](Node* node) {
+        bool result = false;
+        if (!isOperator(node->data)) {
+            auto it = values.find(node->data);
+            result = it != values.end() && it->second;
+        } else if (node->data == '~') {
+            result = !value[node->right];
+        } else {
+            bool leftVal = value[node->left];
+            bool rightVal = value[node->right];
+            switch (node->data) {
+                case '+': result = leftVal || rightVal; break;
+                case '*': result = leftVal && rightVal; break;
+                case '>': result = (!leftVal) || rightVal; break;
+            }
+        }
+        value[node] = result;
+    });
+    return value[root];
 }
 
 void printInfixFromTree(Node* root) {
-    if (!root) return;
-    if (!root->left && !root->right) { cout << root->data; return; }
-    if (root->data == '~') {
-        cout << "~";
-        if (root->right && isOperator(root->right->data)) { cout << "("; printInfixFromTree(root->right); cout << ")"; }
-        else { printInfixFromTree(root->right); }
-        return;
-    }
-    cout << "(";
-    printInfixFromTree(root->left);
-    cout << " " << root->data << " ";
-    printInfixFromTree(root->right);
-    cout << ")";
+    string infix;
+    appendInfix(root, infix, true);
+    cout << infix;
 }
 
+// Nodes are hash-consed, so every rewrite below is a function of the node
+// pointer alone. Each one memoizes its results per call, so a subformula
+// shared by several parents is rewritten once and the work follows the size
+// of the DAG, not of the expanded tree.
+using RewriteMemo = unordered_map<Node*, Node*>;
+
 // Step 1: Replace implication (P > Q) with (~P + Q)
 Node* impl_free(Node* root) {
-    if (!root) return nullptr;
-    root->left = impl_free(root->left);
-    root->right = impl_free(root->right);
-    if (root->data == '>') {
-        Node* notP = new Node('~'); notP->right = root->left;
-        Node* orNode = new Node('+'); orNode->left = notP; orNode->right = root->right;
-        root->left = root->right = nullptr; delete root; return orNode;
-    }
-    return root;
+    RewriteMemo rewritten{{nullptr, nullptr}};
+    forEachPostorder(root, [&](Node* node) {
+        Node* left = rewritten[node->left];
+        Node* right = rewritten[node->right];
+        rewritten[node] = (node->data == '>') ? nodes.make('+', nodes.make('~', nullptr, left), right)
+                                              : nodes.make(node->data, left, right);
+    });
+    return rewritten[root];
 }
 
-// Step 2: Convert to Negation Normal Form (NNF)
+// Step 2: Convert to Negation Normal Form (NNF). A node is rewritten once its
+// operands are; under a negation those operands are new negated nodes, so the
+// stack may grow with nodes that are not in the input tree.
 Node* nnf(Node* root) {
-    if (!root) return nullptr;
-    if (root->data == '~') {
-        Node* sub = root->right;
-        if (sub->data == '~') { Node* newRoot = nnf(sub->right); sub->right = nullptr; delete root; delete sub; return newRoot; }
-        if (sub->data == '+') { // De Morgan's Law: ~(A + B) => ~A * ~B
-            Node* andNode = new Node('*');
-            Node* notA = new Node('~'); notA->right = sub->left;
-            Node* notB = new Node('~'); notB->right = sub->right;
-            andNode->left = nnf(notA); andNode->right = nnf(notB);
-            sub->left = sub->right = nullptr; delete root; delete sub; return andNode;
+    RewriteMemo rewritten{{nullptr, nullptr}};
+    vector<Node*> pending{root};
+    while (!pending.empty()) {
+        Node* node = pending.back();
+        if (rewritten.count(node)) {
+            pending.pop_back();
+            continue;
         }
-        if (sub->data == '*') { // De Morgan's Law: ~(A * B) => ~A + ~B
-            Node* orNode = new Node('+');
-            Node* notA = new Node('~'); notA->right = sub->left;
-            Node* notB = new Node('~'); notB->right = sub->right;
-            orNode->left = nnf(notA); orNode->right = nnf(notB);
-            sub->left = sub->right = nullptr; delete root; delete sub; return orNode;
+        if (!node->left && !node->right) {
+            rewritten[node] = node;
+            pending.pop_back();
+            continue;
+        }
+        Node* sub = node->right;
+        bool negation = node->data == '~' && sub;
+        Node* first = node->left;
+        Node* second = node->right;
+        if (negation && sub->data == '~') { // ~~A => A
+            first = sub->right;
+            second = nullptr;
+        } else if (negation && (sub->data == '+' || sub->data == '*')) { // De Morgan's Law
+            first = nodes.make('~', nullptr, sub->left);
+            second = nodes.make('~', nullptr, sub->right);
+        }
+        bool ready = true;
+        if (!rewritten.count(second)) {
+            pending.push_back(second);
+            ready = false;
         }
+        if (!rewritten.count(first)) {
+            pending.push_back(first);
+            ready = false;
+        }
+        if (!ready) continue;
+        pending.pop_back();
+
+        Node* result;
+        if (negation && sub->data == '~')
+            result = rewritten[first];
+        else if (negation && sub->data == '+') // ~(A + B) => ~A * ~B
+            result = nodes.make('*', rewritten[first], rewritten[second]);
+        else if (negation && sub->data == '*') // ~(A * B) => ~A + ~B
+            result = nodes.make('+', rewritten[first], rewritten[second]);
+        else
+            result = nodes.make(node->data, rewritten[first], rewritten[second]);
+        rewritten[node] = result;
     }
-    root->left = nnf(root->left);
-    root->right = nnf(root->right);
-    return root;
+    return rewritten[root];
 }
 
-// Step 3 Helper: Distribute OR over AND for CNF
-Node* distribute(Node* a, Node* b) {
-    if (a->data == '*') { // (X*Y)+Z => (X+Z)*(Y+Z)
-        Node* left = distribute(a->left, copyTree(b));
-        Node* right = distribute(a->right, b);
-        Node* andNode = new Node('*'); andNode->left = left; andNode->right = right;
-        a->left = a->right = nullptr; delete a; return andNode;
+// Memo tables for one cnf() call.
+struct PairHash {
+    size_t operator()(const pair<Node*, Node*>& p) const {
+        size_t h = reinterpret_cast<uintptr_t>(p.first) * 0x9E3779B97F4A7C15ULL;
+        return h ^ (reinterpret_cast<uintptr_t>(p.second) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2));
     }
-    if (b->data == '*') { // X+(Y*Z) => (X+Y)*(X+Z)
-        Node* left = distribute(copyTree(a), b->left);
-        Node* right = distribute(a, b->right);
-        Node* andNode = new Node('*'); andNode->left = left; andNode->right = right;
-        b->left = b->right = nullptr; delete b; return andNode;
+};
+
+struct CnfCache {
+    RewriteMemo converted;
+    unordered_map<pair<Node*, Node*>, Node*, PairHash> distributed;
+};
+
+// Step 3 Helper: Distribute OR over AND for CNF. Operands are shared, not
+// copied; every pair is distributed once, children first, from a stack.
+Node* distribute(Node* a, Node* b, CnfCache& cache) {
+    vector<pair<Node*, Node*>> pending{{a, b}};
+    while (!pending.empty()) {
+        pair<Node*, Node*> current = pending.back();
+        if (cache.distributed.count(current)) {
+            pending.pop_back();
+            continue;
+        }
+        auto [x, y] = current;
+        pair<Node*, Node*> first, second;
+        if (x && x->data == '*') { // (X*Y)+Z => (X+Z)*(Y+Z)
+            first = {x->left, y};
+            second = {x->right, y};
+        } else if (y && y->data == '*') { // X+(Y*Z) => (X+Y)*(X+Z)
+            first = {x, y->left};
+            second = {x, y->right};
+        } else {
+            cache.distributed.emplace(current, nodes.make('+', x, y));
+            pending.pop_back();
+            continue;
+        }
+        auto left = cache.distributed.find(first);
+        auto right = cache.distributed.find(second);
+        if (left == cache.distributed.end() || right == cache.distributed.end()) {
+            if (right == cache.distributed.end()) pending.push_back(second);
+            if (left == cache.distributed.end()) pending.push_back(first);
+            continue;
+        }
+        cache.distributed.emplace(current, nodes.make('*', left->second, right->second));
+        pending.pop_back();
     }
-    Node* orNode = new Node('+'); orNode->left = a; orNode->right = b;
-    return orNode;
+    return cache.distributed.at({a, b});
 }
 
 // Step 3: Convert NNF to CNF by distribution
 Node* cnf(Node* root) {
-    if (!root) return nullptr;
-    root->left = cnf(root->left);
-    root->right = cnf(root->right);
-    if (root->data == '+') {
-        Node* distributed_tree = distribute(root->left, root->right);
-        root->left = root->right = nullptr; delete root; return distributed_tree;
-    }
-    return root;
+    CnfCache cache;
+    cache.converted[nullptr] = nullptr;
+    forEachPostorder(root, [&](Node* node) {
+        Node* result = node; // Variables are already in CNF
+        if (node->left || node->right) {
+            Node* left = cache.converted[node->left];
+            Node* right = cache.converted[node->right];
+            result = (node->data == '+') ? distribute(left, right, cache) : nodes.make(node->data, left, right);
+        }
+        cache.converted[node] = result;
+    });
+    return cache.converted[root];
 }
 
-
 // --- Section 4: CNF Validity Check (Task 7) ---
 
 // Checks if a single clause is a tautology (e.g., contains P + ~P)
@@ -440,7 +607,7 @@ int main() {
                 auto comp_stop = high_resolution_clock::now();
 
                 printTree(root);
-                deleteTree(root);
+                releaseAllNodes();
 
                 auto total_stop = high_resolution_clock::now();
 
@@ -464,7 +631,7 @@ int main() {
                 auto comp_stop = high_resolution_clock::now();
 
                 cout << "Generated Infix: " << infix << endl;
-                deleteTree(root);
+                releaseAllNodes();
 
                 auto total_stop = high_resolution_clock::now();
 
@@ -488,7 +655,7 @@ int main() {
                 auto comp_stop = high_resolution_clock::now();
 
                 cout << "Tree Height: " << height << endl;
-                deleteTree(root);
+                releaseAllNodes();
 
                 auto total_stop = high_resolution_clock::now();
 
@@ -544,7 +711,7 @@ int main() {
                     }
                 }
 
-                deleteTree(root);
+                releaseAllNodes();
 
                 auto total_stop = high_resolution_clock::now();
 
@@ -571,7 +738,7 @@ int main() {
                 cout << "Conjunctive Normal Form (CNF): ";
                 printInfixFromTree(root);
                 cout << endl;
-                deleteTree(root);
+                releaseAllNodes();
 
                 auto total_stop = high_resolution_clock::now();
                 cout << " Computation Time: "
@@ -5,30 +5,325 @@
 #include <vector>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <limits>
 #include <stdexcept>
 #include <sstream> 
+#include <fstream>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PLT_X86_KERNELS 1 // AVX2 / AVX-512 truth-table kernels with runtime dispatch
+#include <immintrin.h>
+#endif
+#if !defined(_WIN32)
+#define PLT_POSIX_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 // --- Data Structures ---
+enum class Op : uint8_t { Var, Not, And, Or, Implies };
+
+// Parse-tree node. Operators are stored as an opcode and variables as an ID
+// into the global symbol table, so a node is a small POD.
 struct Node {
-    string data; 
+    Op op;
+    uint32_t var; // Symbol ID, only meaningful when op == Op::Var
     Node* left;
     Node* right;
+};
+
+// --- Symbol Table ---
+// Interns variable names (P, Q, P17, ...) to dense 32-bit IDs.
+class SymbolTable {
+public:
+    uint32_t intern(const string& name) {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(names.size());
+        names.push_back(name);
+        ids.emplace(name, id);
+        return id;
+    }
+
+    const string& name(uint32_t id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+    // Forgets every name; IDs handed out before are no longer valid.
+    void clear() {
+        names.clear();
+        ids.clear();
+    }
+
+private:
+    vector<string> names;
+    unordered_map<string, uint32_t> ids;
+};
+
+SymbolTable symbols;
+
+// --- Node Arena ---
+// Bump allocator for parse-tree nodes. Nodes are carved out of large blocks,
+// so the nodes of one formula sit next to each other in memory, and the whole
+// formula is released at once by reset() instead of node-by-node deletes.
+class NodeArena {
+public:
+    explicit NodeArena(size_t nodes_per_block = 4096)
+        : block_size(nodes_per_block), current_block(0), used_in_block(0), live_nodes(0) {}
+
+    ~NodeArena() {
+        for (Node* block : blocks) {
+            ::operator delete(block);
+        }
+    }
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
 
-    Node(string val) : data(val), left(nullptr), right(nullptr) {}
+    Node* make(Op op, uint32_t var, Node* left, Node* right) {
+        if (used_in_block == block_size) {
+            current_block++;
+            used_in_block = 0;
+        }
+        if (current_block == blocks.size()) {
+            blocks.push_back(static_cast<Node*>(::operator new(block_size * sizeof(Node))));
+        }
+        Node* node = blocks[current_block] + used_in_block;
+        node->op = op;
+        node->var = var;
+        node->left = left;
+        node->right = right;
+        used_in_block++;
+        live_nodes++;
+        return node;
+    }
+
+    // Releases every node handed out since the last reset. Nodes are trivially
+    // destructible, so this only rewinds the bump pointer; the blocks are kept
+    // and reused by the next formula.
+    void reset() {
+        current_block = 0;
+        used_in_block = 0;
+        live_nodes = 0;
+    }
+
+    size_t size() const { return live_nodes; }
+
+private:
+    vector<Node*> blocks;
+    size_t block_size;
+    size_t current_block;
+    size_t used_in_block;
+    size_t live_nodes;
+};
+
+// All tree builders and rewriters allocate from this arena. A formula is
+// freed by resetting the arena once nothing refers to its nodes any more.
+NodeArena nodeArena;
+
+// --- Hash-Consing Node Factory ---
+// Nodes are immutable once built and structurally equal subformulas are the
+// same node, so the rewriters below work on a shared DAG: distributing a
+// subformula over a conjunction reuses it instead of copying it.
+struct NodeHash {
+    size_t operator()(const Node* n) const {
+        size_t h = static_cast<size_t>(n->op) * 0x9E3779B97F4A7C15ULL;
+        h ^= n->var + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        h ^= reinterpret_cast<uintptr_t>(n->left) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        h ^= reinterpret_cast<uintptr_t>(n->right) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+struct NodeEq {
+    bool operator()(const Node* a, const Node* b) const {
+        return a->op == b->op && a->var == b->var && a->left == b->left && a->right == b->right;
+    }
 };
 
+unordered_set<Node*, NodeHash, NodeEq> nodeTable;
+
+Node* mkNode(Op op, Node* left = nullptr, Node* right = nullptr, uint32_t var = 0) {
+    Node probe{op, var, left, right};
+    auto it = nodeTable.find(&probe);
+    if (it != nodeTable.end()) return *it;
+    Node* node = nodeArena.make(op, var, left, right);
+    nodeTable.insert(node);
+    return node;
+}
+
+Node* mkVar(uint32_t var) {
+    return mkNode(Op::Var, nullptr, nullptr, var);
+}
+
 using Literal = int;
 using Clause = vector<Literal>;
-using DimacsCNF = vector<Clause>;
 
-// --- Forward Declaration ---
-// FIX: Declaring the recursive helper function before its usage in buildParseTree
-Node* buildParseTree_helper(string& expression); 
+// --- Flat Clause Database ---
+// Read-only view of one clause inside a DimacsCNF (or of a Clause vector).
+class ClauseView {
+public:
+    ClauseView(const Literal* first, const Literal* last) : first_(first), last_(last) {}
+    ClauseView(const Clause& clause) : first_(clause.data()), last_(clause.data() + clause.size()) {}
+
+    const Literal* begin() const { return first_; }
+    const Literal* end() const { return last_; }
+    size_t size() const { return last_ - first_; }
+    bool empty() const { return first_ == last_; }
+    Literal operator[](size_t i) const { return first_[i]; }
+
+private:
+    const Literal* first_;
+    const Literal* last_;
+};
+
+// Non-owning CSR view of a clause database: `clauses` clauses whose literals
+// are lits[offsets[i] .. offsets[i + 1]). Both an in-memory DimacsCNF and a
+// memory-mapped binary cache (CnfCacheFile) hand these out, so solvers and
+// checkers read either without copying a single clause.
+class CnfView {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = random_access_iterator_tag;
+        using value_type = ClauseView;
+        using difference_type = ptrdiff_t;
+        using pointer = void;
+        using reference = ClauseView;
+
+        const_iterator(const Literal* lits, const uint64_t* offsets, size_t index)
+            : lits(lits), offsets(offsets), index(index) {}
+        ClauseView operator*() const { return (*this)[0]; }
+        ClauseView operator[](difference_type n) const {
+            return ClauseView(lits + offsets[index + n], lits + offsets[index + n + 1]);
+        }
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++index; return old; }
+        const_iterator& operator--() { --index; return *this; }
+        const_iterator operator--(int) { const_iterator old = *this; --index; return old; }
+        const_iterator& operator+=(difference_type n) { index += n; return *this; }
+        const_iterator& operator-=(difference_type n) { index -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return const_iterator(lits, offsets, index + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(lits, offsets, index - n); }
+        difference_type operator-(const const_iterator& other) const { return (difference_type)index - (difference_type)other.index; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator<(const const_iterator& other) const { return index < other.index; }
+        bool operator>(const const_iterator& other) const { return index > other.index; }
+        bool operator<=(const const_iterator& other) const { return index <= other.index; }
+        bool operator>=(const const_iterator& other) const { return index >= other.index; }
+
+    private:
+        const Literal* lits;
+        const uint64_t* offsets;
+        size_t index;
+    };
+
+    CnfView(const Literal* lits, const uint64_t* offsets, size_t clauses)
+        : lits_(lits), offsets_(offsets), clauses_(clauses) {}
+
+    size_t size() const { return clauses_; }
+    bool empty() const { return clauses_ == 0; }
+    size_t literalCount() const { return offsets_[clauses_]; }
+
+    ClauseView operator[](size_t i) const {
+        return ClauseView(lits_ + offsets_[i], lits_ + offsets_[i + 1]);
+    }
+    const_iterator begin() const { return const_iterator(lits_, offsets_, 0); }
+    const_iterator end() const { return const_iterator(lits_, offsets_, clauses_); }
+
+    const Literal* literals() const { return lits_; }
+    const uint64_t* offsets() const { return offsets_; }
+
+private:
+    const Literal* lits_;
+    const uint64_t* offsets_;
+    size_t clauses_;
+};
+
+// CNF in compressed sparse row form: every literal in one contiguous array
+// and one offset per clause, instead of a heap-allocated vector per clause.
+// Clause i is lits[offsets[i] .. offsets[i + 1]). Iteration yields
+// ClauseViews, so `for (const auto& clause : formula)` reads as before.
+class DimacsCNF {
+public:
+    using const_iterator = CnfView::const_iterator;
+
+    DimacsCNF() : offsets_(1, 0) {}
+    DimacsCNF(initializer_list<Clause> clauses) : offsets_(1, 0) {
+        for (const Clause& clause : clauses) push_back(clause);
+    }
+    // Deep copy of a view, e.g. to own clauses loaded from a binary cache.
+    explicit DimacsCNF(CnfView view)
+        : lits_(view.literals(), view.literals() + view.literalCount()),
+          offsets_(view.offsets(), view.offsets() + view.size() + 1) {}
+
+    size_t size() const { return offsets_.size() - 1; }
+    bool empty() const { return size() == 0; }
+    size_t literalCount() const { return lits_.size(); }
+
+    CnfView view() const { return CnfView(lits_.data(), offsets_.data(), size()); }
+    operator CnfView() const { return view(); }
+
+    ClauseView operator[](size_t i) const {
+        return ClauseView(lits_.data() + offsets_[i], lits_.data() + offsets_[i + 1]);
+    }
+    const_iterator begin() const { return view().begin(); }
+    const_iterator end() const { return view().end(); }
+
+    void push_back(const Clause& clause) { append(clause.begin(), clause.end()); }
+    template <typename It>
+    void append(It first, It last) {
+        lits_.insert(lits_.end(), first, last);
+        offsets_.push_back(lits_.size());
+    }
+    // Appends every clause of `other` (a block copy, no per-clause work).
+    void append(const DimacsCNF& other) {
+        size_t base = lits_.size();
+        lits_.insert(lits_.end(), other.lits_.begin(), other.lits_.end());
+        for (size_t i = 1; i < other.offsets_.size(); ++i) offsets_.push_back(base + other.offsets_[i]);
+    }
+
+    void reserve(size_t clauses, size_t literals = 0) {
+        offsets_.reserve(clauses + 1);
+        lits_.reserve(literals);
+    }
+    void clear() {
+        lits_.clear();
+        offsets_.assign(1, 0);
+    }
+    void swap(DimacsCNF& other) {
+        lits_.swap(other.lits_);
+        offsets_.swap(other.offsets_);
+    }
+
+    // Raw CSR arrays, for bulk consumers and serialisation.
+    const vector<Literal>& literals() const { return lits_; }
+    const vector<uint64_t>& offsets() const { return offsets_; }
+
+    bool operator==(const DimacsCNF& other) const { return lits_ == other.lits_ && offsets_ == other.offsets_; }
+    bool operator!=(const DimacsCNF& other) const { return !(*this == other); }
 
+private:
+    vector<Literal> lits_;
+    vector<uint64_t> offsets_;
+};
 
 // --- Helper Functions ---
 bool isOperator(const string& s) {
@@ -47,6 +342,32 @@ int getPrecedence(const string& op) {
     return -1; 
 }
 
+Op tokenToOp(const string& token) {
+    if (token == "~") return Op::Not;
+    if (token == "*") return Op::And;
+    if (token == "+") return Op::Or;
+    if (token == ">") return Op::Implies;
+    return Op::Var;
+}
+
+const char* opSymbol(Op op) {
+    switch (op) {
+        case Op::Not: return "~";
+        case Op::And: return "*";
+        case Op::Or: return "+";
+        case Op::Implies: return ">";
+        default: return "";
+    }
+}
+
+bool isBinary(Op op) {
+    return op == Op::And || op == Op::Or || op == Op::Implies;
+}
+
+string nodeLabel(const Node* node) {
+    return node->op == Op::Var ? symbols.name(node->var) : string(opSymbol(node->op));
+}
+
 vector<string> tokenize(const string& infix) {
     vector<string> tokens;
     string current_token;
@@ -130,473 +451,3473 @@ string infixToPrefix(string infix) {
     return final_prefix;
 }
 
-string getNextToken(string& expression) {
-    // Trims leading spaces
-    expression.erase(0, expression.find_first_not_of(" \t\n\r"));
-    if (expression.empty()) return "";
-    
-    size_t first_space = expression.find(' ');
-    if (first_space == string::npos) {
-        string token = expression;
-        expression.clear();
-        return token;
+// Returns the next space-separated token of a prefix expression starting at
+// `pos` and advances `pos` past it; "" at the end of the input.
+string nextPrefixToken(const string& expression, size_t& pos) {
+    pos = expression.find_first_not_of(" \t\n\r", pos);
+    if (pos == string::npos) {
+        pos = expression.size();
+        return "";
     }
-    
-    string token = expression.substr(0, first_space);
-    expression.erase(0, first_space);
+    size_t end = expression.find(' ', pos);
+    if (end == string::npos) end = expression.size();
+    string token = expression.substr(pos, end - pos);
+    pos = end;
     return token;
 }
 
+// --- Tree Traversal ---
+// Formulas can be millions of nodes deep (e.g. a long left-nested chain), so
+// no traversal recurses once per level: each keeps an explicit stack on the
+// heap whose size is bounded by the number of nodes.
+
+// Calls visit(node) once for every distinct node reachable from root, after
+// its children (left subtree first). Nodes are hash-consed, so a subformula
+// shared by several parents is visited only once.
+template <typename Fn>
+void forEachPostorder(Node* root, Fn visit) {
+    if (!root) return;
+    unordered_set<Node*> done;
+    vector<pair<Node*, bool>> pending{{root, false}}; // (node, children pushed)
+    while (!pending.empty()) {
+        Node* node = pending.back().first;
+        if (done.count(node)) {
+            pending.pop_back();
+        } else if (pending.back().second) {
+            pending.pop_back();
+            done.insert(node);
+            visit(node);
+        } else {
+            pending.back().second = true;
+            if (node->right && !done.count(node->right)) pending.push_back({node->right, false});
+            if (node->left && !done.count(node->left)) pending.push_back({node->left, false});
+        }
+    }
+}
+
+// Builds the tree of a space-separated prefix expression. Operators wait on
+// a stack until their operands are complete; operands missing at the end of
+// the input are left as nullptr.
 Node* buildParseTree(string expression) {
-    if (expression.empty()) return nullptr;
-    // We pass a copy of expression, but the recursive helper needs a reference to modify state
-    return buildParseTree_helper(expression); 
+    struct Pending {
+        Op op;
+        Node* left;
+        bool has_left;
+    };
+    vector<Pending> pending;
+    size_t pos = 0;
+    for (string token = nextPrefixToken(expression, pos); !token.empty(); token = nextPrefixToken(expression, pos)) {
+        Op op = tokenToOp(token);
+        if (op != Op::Var) {
+            pending.push_back({op, nullptr, false});
+            continue;
+        }
+        // A finished operand completes every operator still waiting on its last operand.
+        Node* node = mkVar(symbols.intern(token));
+        while (true) {
+            if (pending.empty()) return node; // Tokens after a complete expression are ignored
+            Pending& top = pending.back();
+            if (top.op != Op::Not && !top.has_left) {
+                top.left = node;
+                top.has_left = true;
+                break;
+            }
+            node = (top.op == Op::Not) ? mkNode(Op::Not, node) : mkNode(top.op, top.left, node);
+            pending.pop_back();
+        }
+    }
+    Node* node = nullptr;
+    while (!pending.empty()) {
+        Pending& top = pending.back();
+        node = (top.op == Op::Not || !top.has_left) ? mkNode(top.op, node) : mkNode(top.op, top.left, node);
+        pending.pop_back();
+    }
+    return node;
 }
 
-Node* buildParseTree_helper(string& expression) {
-    if (expression.empty()) return nullptr;
+// Frees every node of the current formula in one step.
+void releaseTree() {
+    nodeTable.clear();
+    nodeArena.reset();
+}
 
-    string token = getNextToken(expression);
-    if (token.empty()) return nullptr;
+void printTree(Node* root, const string& prefix = "", bool isLeft = false) {
+    struct Line {
+        Node* node;
+        size_t indent; // Length of the prefix this node is printed with
+        bool isLeft;
+    };
+    string indent = prefix;
+    vector<Line> pending{{root, prefix.size(), isLeft}};
+    while (!pending.empty()) {
+        Line line = pending.back();
+        pending.pop_back();
+        if (line.node == nullptr) continue;
+        indent.resize(line.indent);
+        cout << indent << (line.isLeft ? "|-- " : "L-- ") << nodeLabel(line.node) << '\n';
 
-    Node* node = new Node(token);
+        // Children share this node's indent plus one column; the left child prints first.
+        indent += line.isLeft ? "|   " : "    ";
+        pending.push_back({line.node->right, indent.size(), false});
+        pending.push_back({line.node->left, indent.size(), true});
+    }
+    cout.flush();
+}
 
-    if (isOperator(token)) {
-        node->left = buildParseTree_helper(expression);
-        if (token != "~") { 
-            node->right = buildParseTree_helper(expression);
+// Appends the fully parenthesised infix form of root to `out`. A negated
+// subformula is parenthesised when it is binary, or with `wrap_negations`
+// whenever it is not a variable (~(~P) instead of ~~P).
+void appendInfix(Node* root, string& out, bool wrap_negations) {
+    // Each entry is either a node still to be written or literal text.
+    vector<pair<Node*, const char*>> pending{{root, nullptr}};
+    while (!pending.empty()) {
+        auto [node, text] = pending.back();
+        pending.pop_back();
+        if (text) {
+            out += text;
+            continue;
+        }
+        if (node == nullptr) continue;
+        if (node->op == Op::Var) {
+            out += symbols.name(node->var);
+        } else if (node->op == Op::Not) {
+            bool wrap = node->left && (wrap_negations ? node->left->op != Op::Var : isBinary(node->left->op));
+            out += wrap ? "~(" : "~";
+            if (wrap) pending.push_back({nullptr, ")"});
+            pending.push_back({node->left, nullptr});
+        } else {
+            out += '(';
+            pending.push_back({nullptr, ")"});
+            pending.push_back({node->right, nullptr});
+            pending.push_back({nullptr, " "});
+            pending.push_back({nullptr, opSymbol(node->op)});
+            pending.push_back({nullptr, " "});
+            pending.push_back({node->left, nullptr});
         }
     }
-    return node;
 }
 
-void deleteTree(Node* root) {
-    if (root == nullptr) return;
-    deleteTree(root->left);
-    deleteTree(root->right);
-    delete root;
+string parseTreeToInfix(Node* root) {
+    string infix;
+    appendInfix(root, infix, false);
+    return infix;
 }
 
-void printTree(Node* root, const string& prefix = "", bool isLeft = false) {
-    if (root != nullptr) {
-        cout << prefix;
-        cout << (isLeft ? "|-- " : "L-- ");
-        cout << root->data << endl;
+int getTreeHeight(Node* root) {
+    unordered_map<Node*, int> height{{nullptr, -1}}; // Height of an empty tree is often defined as -1
+    forEachPostorder(root, [&](Node* node) {
+        height[node] = 1 + max(height[node->left], height[node->right]);
+    });
+    return height[root];
+}
 
-        printTree(root->left, prefix + (isLeft ? "|   " : "    "), true);
-        printTree(root->right, prefix + (isLeft ? "|   " : "    "), false);
+void getVariables(Node* root, set<string>& vars) {
+    forEachPostorder(root, [&](Node* node) {
+        if (node->op == Op::Var) vars.insert(symbols.name(node->var));
+    });
+}
+
+// `values` is indexed by symbol ID (0 = false, 1 = true). And, Or and
+// Implies short-circuit, so the right operand is only visited when needed.
+bool evaluate(Node* root, const vector<char>& values) {
+    struct Frame {
+        Node* node;
+        int stage; // Operands evaluated so far
+    };
+    vector<Frame> pending{{root, 0}};
+    vector<char> results;
+    while (!pending.empty()) {
+        Frame& frame = pending.back();
+        Node* node = frame.node;
+        if (node == nullptr) throw runtime_error("Invalid expression tree.");
+        if (node->op == Op::Var) {
+            if (node->var >= values.size()) {
+                throw runtime_error("No truth value for variable '" + symbols.name(node->var) + "'");
+            }
+            results.push_back(values[node->var] != 0);
+            pending.pop_back();
+            continue;
+        }
+        if (frame.stage == 0) {
+            frame.stage = 1;
+            pending.push_back({node->left, 0});
+            continue;
+        }
+        if (node->op == Op::Not) {
+            results.back() = !results.back();
+            pending.pop_back();
+            continue;
+        }
+        if (frame.stage == 1) {
+            char left = results.back();
+            bool decided = (node->op == Op::And) ? !left : left == (node->op == Op::Or);
+            if (decided) {
+                results.back() = node->op != Op::And; // false for And, true for Or and Implies
+                pending.pop_back();
+            } else {
+                results.pop_back(); // The result is the right operand's value
+                frame.stage = 2;
+                pending.push_back({node->right, 0});
+            }
+            continue;
+        }
+        pending.pop_back();
     }
+    return results.back();
 }
 
-string parseTreeToInfix(Node* root) {
-    if (root == nullptr) return "";
-    if (isOperand(root->data)) return root->data;
+// --- Compiled Evaluation ---
+// A formula compiled to a flat postfix program. Variables are renumbered to
+// dense indices 0..n-1, so evaluating a row reads a plain array instead of
+// walking pointers and hashing variable names.
+struct Instr {
+    Op op;
+    uint32_t arg; // Dense variable index, only meaningful when op == Op::Var
+};
 
-    string left = parseTreeToInfix(root->left);
-    string right = parseTreeToInfix(root->right);
+struct CompiledFormula {
+    vector<Instr> code;
+    vector<string> vars; // Dense index -> variable name
+    size_t max_stack = 0;
+};
+
+// varList fixes the dense index of each variable (e.g. truth-table column order).
+CompiledFormula compileFormula(Node* root, const vector<string>& varList) {
+    CompiledFormula out;
+    out.vars = varList;
+    unordered_map<uint32_t, uint32_t> dense;
+    for (size_t i = 0; i < varList.size(); ++i) {
+        dense[symbols.intern(varList[i])] = static_cast<uint32_t>(i);
+    }
 
-    if (root->data == "~") {
-        // Add parenthesis if the child is a complex expression
-        if(root->left && (root->left->data == "+" || root->left->data == "*" || root->left->data == ">")) {
-             return "~(" + left + ")"; 
+    // Emits the tree in postfix order from an explicit stack, tracking the
+    // height the evaluation stack reaches at run time.
+    vector<pair<Node*, bool>> pending{{root, false}}; // (node, operands emitted)
+    size_t height = 0;
+    while (!pending.empty()) {
+        auto [node, emitted] = pending.back();
+        pending.pop_back();
+        if (node == nullptr) throw runtime_error("Invalid expression tree.");
+        if (node->op == Op::Var) {
+            out.code.push_back({Op::Var, dense.at(node->var)});
+            out.max_stack = max(out.max_stack, ++height);
+        } else if (emitted) {
+            out.code.push_back({node->op, 0});
+            if (node->op != Op::Not) height--;
+        } else {
+            pending.push_back({node, true});
+            if (node->op != Op::Not) pending.push_back({node->right, false});
+            pending.push_back({node->left, false});
         }
-        return "~" + left;
     }
-    return "(" + left + " " + root->data + " " + right + ")";
+    return out;
 }
 
-int getTreeHeight(Node* root) {
-    if (root == nullptr) {
-        return -1; // Height of an empty tree is often defined as -1
+// `values` holds one 0/1 entry per dense variable index; `stack` is scratch
+// space that is reused across calls.
+bool runCompiled(const CompiledFormula& f, const char* values, vector<char>& stack) {
+    if (stack.size() < f.max_stack) stack.resize(f.max_stack);
+    char* sp = stack.data();
+    for (const Instr& in : f.code) {
+        switch (in.op) {
+            case Op::Var: *sp++ = values[in.arg]; break;
+            case Op::Not: sp[-1] = !sp[-1]; break;
+            case Op::And: sp--; sp[-1] = sp[-1] & sp[0]; break;
+            case Op::Or: sp--; sp[-1] = sp[-1] | sp[0]; break;
+            case Op::Implies: sp--; sp[-1] = (!sp[-1]) | sp[0]; break;
+        }
     }
-    return 1 + max(getTreeHeight(root->left), getTreeHeight(root->right));
+    return stack[0];
 }
 
-void getVariables(Node* root, set<string>& vars) {
-    if (root == nullptr) return;
-    if (isOperand(root->data)) {
-        vars.insert(root->data);
+// --- Bit-Parallel Truth Tables ---
+// Row i gives variable j the value (i >> (n-1-j)) & 1. Over the 64 rows of
+// block b (rows 64b .. 64b+63) a variable whose bit position is 6 or more is
+// constant, and one with a lower position follows a fixed pattern. Every
+// column is therefore a single uint64_t and the formula can be evaluated on
+// 64 rows at once with &, | and ~.
+const uint64_t kLowBitPatterns[6] = {
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL,
+};
+
+uint64_t variableColumn(int n, int j, uint64_t block) {
+    int shift = n - 1 - j;
+    if (shift < 6) return kLowBitPatterns[shift];
+    return ((block >> (shift - 6)) & 1) ? ~0ULL : 0ULL;
+}
+
+// Bit k of the result is set when row 64 * block + k is a model. Tables with
+// fewer than 64 rows only use the low 2^n bits.
+uint64_t evaluateBlock(const CompiledFormula& f, uint64_t block, vector<uint64_t>& stack) {
+    if (stack.size() < f.max_stack) stack.resize(f.max_stack);
+    int n = f.vars.size();
+    uint64_t* sp = stack.data();
+    for (const Instr& in : f.code) {
+        switch (in.op) {
+            case Op::Var: *sp++ = variableColumn(n, in.arg, block); break;
+            case Op::Not: sp[-1] = ~sp[-1]; break;
+            case Op::And: sp--; sp[-1] &= sp[0]; break;
+            case Op::Or: sp--; sp[-1] |= sp[0]; break;
+            case Op::Implies: sp--; sp[-1] = ~sp[-1] | sp[0]; break;
+        }
+    }
+    return stack[0];
+}
+
+// --- Vectorized Truth-Table Kernels ---
+// The same word-level evaluation as evaluateBlock(), run on 4 (AVX2) or 8
+// (AVX-512) consecutive blocks per instruction, i.e. 256 or 512 rows. The
+// kernel is picked once at runtime from the CPU features; other compilers
+// and CPUs use the scalar loop.
+enum class TruthKernel { Scalar, AVX2, AVX512 };
+
+TruthKernel detectTruthKernel() {
+#ifdef PLT_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return TruthKernel::AVX512;
+    if (__builtin_cpu_supports("avx2")) return TruthKernel::AVX2;
+#endif
+    return TruthKernel::Scalar;
+}
+
+const TruthKernel truthKernel = detectTruthKernel();
+
+const char* truthKernelName(TruthKernel kernel) {
+    switch (kernel) {
+        case TruthKernel::AVX512: return "AVX-512 (512 rows/op)";
+        case TruthKernel::AVX2: return "AVX2 (256 rows/op)";
+        default: return "scalar (64 rows/op)";
     }
-    getVariables(root->left, vars);
-    getVariables(root->right, vars);
 }
 
-bool evaluate(Node* root, const unordered_map<string, bool>& values) {
-    if (root == nullptr) throw runtime_error("Invalid expression tree.");
-    if (isOperand(root->data)) {
-        if (values.find(root->data) == values.end()) {
-            throw runtime_error("No truth value for variable '" + root->data + "'");
+// Column words of every variable for `lanes` consecutive blocks, laid out
+// variable-major so that one variable's lanes are contiguous.
+void fillVariableColumns(int n, uint64_t first, int lanes, vector<uint64_t>& cols) {
+    cols.resize(static_cast<size_t>(n) * lanes);
+    for (int j = 0; j < n; ++j) {
+        for (int k = 0; k < lanes; ++k) {
+            cols[j * lanes + k] = variableColumn(n, j, first + k);
         }
-        return values.at(root->data);
     }
+}
 
-    if (root->data == "~") {
-        return !evaluate(root->left, values);
+#ifdef PLT_X86_KERNELS
+__attribute__((target("avx2")))
+void evaluateBlocksAVX2(const CompiledFormula& f, uint64_t first, uint64_t count, uint64_t* out) {
+    const int W = 4;
+    int n = f.vars.size();
+    vector<uint64_t> cols;
+    vector<uint64_t> stack(f.max_stack * W);
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    for (uint64_t b = 0; b < count; b += W) {
+        fillVariableColumns(n, first + b, W, cols);
+        __m256i* sp = reinterpret_cast<__m256i*>(stack.data());
+        for (const Instr& in : f.code) {
+            switch (in.op) {
+                case Op::Var:
+                    _mm256_storeu_si256(sp++, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&cols[in.arg * W])));
+                    break;
+                case Op::Not:
+                    _mm256_storeu_si256(sp - 1, _mm256_xor_si256(_mm256_loadu_si256(sp - 1), ones));
+                    break;
+                case Op::And:
+                    sp--;
+                    _mm256_storeu_si256(sp - 1, _mm256_and_si256(_mm256_loadu_si256(sp - 1), _mm256_loadu_si256(sp)));
+                    break;
+                case Op::Or:
+                    sp--;
+                    _mm256_storeu_si256(sp - 1, _mm256_or_si256(_mm256_loadu_si256(sp - 1), _mm256_loadu_si256(sp)));
+                    break;
+                case Op::Implies:
+                    sp--;
+                    _mm256_storeu_si256(sp - 1, _mm256_or_si256(_mm256_andnot_si256(_mm256_loadu_si256(sp - 1), ones),
+                                                                _mm256_loadu_si256(sp)));
+                    break;
+            }
+        }
+        memcpy(out + b, stack.data(), W * sizeof(uint64_t));
     }
-    
-    bool left_val = evaluate(root->left, values);
-    
-    // Binary operators
-    if (root->data == "+" || root->data == "*" || root->data == ">") {
-        bool right_val = evaluate(root->right, values);
-        if (root->data == "+") return left_val || right_val;
-        if (root->data == "*") return left_val && right_val;
-        if (root->data == ">") return !left_val || right_val;
+}
+
+__attribute__((target("avx512f")))
+void evaluateBlocksAVX512(const CompiledFormula& f, uint64_t first, uint64_t count, uint64_t* out) {
+    const int W = 8;
+    int n = f.vars.size();
+    vector<uint64_t> cols;
+    vector<uint64_t> stack(f.max_stack * W);
+    const __m512i ones = _mm512_set1_epi64(-1);
+    for (uint64_t b = 0; b < count; b += W) {
+        fillVariableColumns(n, first + b, W, cols);
+        uint64_t* sp = stack.data();
+        for (const Instr& in : f.code) {
+            switch (in.op) {
+                case Op::Var:
+                    _mm512_storeu_si512(sp, _mm512_loadu_si512(&cols[in.arg * W]));
+                    sp += W;
+                    break;
+                case Op::Not:
+                    _mm512_storeu_si512(sp - W, _mm512_xor_si512(_mm512_loadu_si512(sp - W), ones));
+                    break;
+                case Op::And:
+                    sp -= W;
+                    _mm512_storeu_si512(sp - W, _mm512_and_si512(_mm512_loadu_si512(sp - W), _mm512_loadu_si512(sp)));
+                    break;
+                case Op::Or:
+                    sp -= W;
+                    _mm512_storeu_si512(sp - W, _mm512_or_si512(_mm512_loadu_si512(sp - W), _mm512_loadu_si512(sp)));
+                    break;
+                case Op::Implies:
+                    sp -= W;
+                    _mm512_storeu_si512(sp - W, _mm512_or_si512(_mm512_xor_si512(_mm512_loadu_si512(sp - W), ones),
+                                                                _mm512_loadu_si512(sp)));
+                    break;
+            }
+        }
+        memcpy(out + b, stack.data(), W * sizeof(uint64_t));
     }
+}
+#endif
 
-    throw runtime_error("Unknown operator in tree: " + root->data);
+// Evaluates blocks [first, first + count) into out[0 .. count) with the
+// fastest available kernel; the tail that does not fill a vector runs scalar.
+void evaluateBlocks(const CompiledFormula& f, uint64_t first, uint64_t count, uint64_t* out,
+                    TruthKernel kernel = truthKernel) {
+    uint64_t done = 0;
+#ifdef PLT_X86_KERNELS
+    if (kernel == TruthKernel::AVX512) {
+        done = count & ~7ULL;
+        evaluateBlocksAVX512(f, first, done, out);
+    } else if (kernel == TruthKernel::AVX2) {
+        done = count & ~3ULL;
+        evaluateBlocksAVX2(f, first, done, out);
+    }
+#else
+    (void)kernel;
+#endif
+    vector<uint64_t> stack;
+    for (uint64_t b = done; b < count; ++b) {
+        out[b] = evaluateBlock(f, first + b, stack);
+    }
 }
 
-Node* impl_free(Node* root) {
-    if (!root) return nullptr;
-    if (root->data == ">") {
-        Node* new_or = new Node("+");
-        Node* new_not = new Node("~");
-        
-        // A > B is logically equivalent to (~A + B)
-        new_not->left = impl_free(root->left);
-        new_or->left = new_not;
-        new_or->right = impl_free(root->right);
-        
-        delete root;
-        return new_or;
+uint64_t rowMask(int n) {
+    return n >= 6 ? ~0ULL : ((1ULL << (1 << n)) - 1);
+}
+
+int popcount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#else
+    int count = 0;
+    for (; x; x &= x - 1) count++;
+    return count;
+#endif
+}
+
+// --- Parallel Row Ranges ---
+// Worker count for parallel truth tables (set with --threads N).
+unsigned threadCount = max(1u, thread::hardware_concurrency());
+
+// Runs fn(first, count, worker) over [0, total) in chunks of `chunk` items on
+// `threads` workers. Each worker starts with a contiguous share of chunks in
+// its own deque and takes from the front; a worker that runs dry steals from
+// the back of another worker's deque, so uneven chunks still balance out.
+void parallelForChunks(uint64_t total, uint64_t chunk, unsigned threads,
+                       const function<void(uint64_t, uint64_t, unsigned)>& fn) {
+    uint64_t num_chunks = (total + chunk - 1) / chunk;
+    if (threads <= 1 || num_chunks <= 1) {
+        for (uint64_t c = 0; c < num_chunks; ++c) {
+            fn(c * chunk, min(chunk, total - c * chunk), 0);
+        }
+        return;
+    }
+    threads = static_cast<unsigned>(min<uint64_t>(threads, num_chunks));
+
+    struct ChunkQueue {
+        mutex lock;
+        deque<uint64_t> chunks;
+    };
+    vector<ChunkQueue> queues(threads);
+    for (uint64_t c = 0; c < num_chunks; ++c) {
+        queues[c * threads / num_chunks].chunks.push_back(c);
+    }
+
+    auto take = [&](unsigned worker, uint64_t& c) {
+        {
+            lock_guard<mutex> guard(queues[worker].lock);
+            if (!queues[worker].chunks.empty()) {
+                c = queues[worker].chunks.front();
+                queues[worker].chunks.pop_front();
+                return true;
+            }
+        }
+        for (unsigned k = 1; k < threads; ++k) {
+            ChunkQueue& victim = queues[(worker + k) % threads];
+            lock_guard<mutex> guard(victim.lock);
+            if (!victim.chunks.empty()) {
+                c = victim.chunks.back();
+                victim.chunks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    };
+
+    vector<thread> workers;
+    for (unsigned w = 0; w < threads; ++w) {
+        workers.emplace_back([&, w]() {
+            uint64_t c;
+            while (take(w, c)) {
+                fn(c * chunk, min(chunk, total - c * chunk), w);
+            }
+        });
+    }
+    for (thread& t : workers) t.join();
+}
+
+uint64_t countModels(const CompiledFormula& program, TruthKernel kernel = truthKernel,
+                     unsigned threads = threadCount) {
+    int n = program.vars.size();
+    uint64_t blocks = n >= 6 ? (1ULL << (n - 6)) : 1;
+    uint64_t mask = rowMask(n);
+    vector<uint64_t> partial(threads, 0);
+    parallelForChunks(blocks, 4096, threads, [&](uint64_t first, uint64_t count, unsigned worker) {
+        vector<uint64_t> words(count);
+        evaluateBlocks(program, first, count, words.data(), kernel);
+        uint64_t models = 0;
+        for (uint64_t b = 0; b < count; ++b) {
+            models += popcount64(words[b] & mask);
+        }
+        partial[worker] += models;
+    });
+    uint64_t models = 0;
+    for (uint64_t p : partial) models += p;
+    return models;
+}
+
+void printModelSummary(uint64_t models, int n) {
+    uint64_t rows = 1ULL << n;
+    cout << "Satisfying rows: " << models << " of " << rows;
+    if (models == rows) cout << " (tautology)";
+    else if (models == 0) cout << " (contradiction)";
+    else cout << " (contingent)";
+    cout << endl;
+}
+
+// --- Truth Table Output ---
+// Collects output in a large block and hands it to the stream in bulk, so
+// rows are never flushed one at a time.
+class BufferedWriter {
+public:
+    explicit BufferedWriter(ostream& stream, size_t capacity = 1 << 20)
+        : out(stream), limit(capacity) {
+        buffer.reserve(capacity);
+    }
+
+    ~BufferedWriter() { flush(); }
+
+    void write(const char* data, size_t len) {
+        if (buffer.size() + len > limit) flush();
+        buffer.insert(buffer.end(), data, data + len);
+    }
+
+    void write(const string& s) { write(s.data(), s.size()); }
+
+    void flush() {
+        if (!buffer.empty()) out.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+private:
+    ostream& out;
+    size_t limit;
+    vector<char> buffer;
+};
+
+// Evaluates the whole table one window of result words at a time (in
+// parallel) and passes each window to fn(first_block, words, count) in order.
+void forEachResultWindow(const CompiledFormula& program,
+                         const function<void(uint64_t, const uint64_t*, uint64_t)>& fn) {
+    int n = program.vars.size();
+    uint64_t blocks = n >= 6 ? (1ULL << (n - 6)) : 1;
+    const uint64_t window = 1 << 16;
+    vector<uint64_t> words(min(blocks, window));
+    for (uint64_t first = 0; first < blocks; first += window) {
+        uint64_t count = min(window, blocks - first);
+        parallelForChunks(count, 1024, threadCount, [&](uint64_t begin, uint64_t len, unsigned) {
+            evaluateBlocks(program, first + begin, len, words.data() + begin);
+        });
+        fn(first, words.data(), count);
+    }
+}
+
+// Writes the table as tab-separated text, one row per assignment in binary
+// counting order of the variables in varList. Returns the number of models.
+uint64_t writeTruthTable(Node* root, const vector<string>& varList, ostream& stream) {
+    int n = varList.size();
+    BufferedWriter out(stream);
+    for (const string& v : varList) {
+        out.write(v + "\t");
     }
-    root->left = impl_free(root->left);
-    root->right = impl_free(root->right);
-    return root;
+    out.write("Result\n");
+
+    CompiledFormula program = compileFormula(root, varList);
+    long long row_count = 1LL << n; 
+    string row(2 * n + 2, '\t');
+    row.back() = '\n';
+    uint64_t models = 0;
+
+    forEachResultWindow(program, [&](uint64_t first, const uint64_t* words, uint64_t count) {
+        long long window_end = min<long long>(row_count, (first + count) * 64);
+        for (long long i = first * 64; i < window_end; ++i) {
+            for (int j = 0; j < n; ++j) {
+                row[2 * j] = ((i >> (n - 1 - j)) & 1) ? 'T' : 'F';
+            }
+            bool result = (words[(i >> 6) - first] >> (i & 63)) & 1;
+            models += result;
+            row[2 * n] = result ? 'T' : 'F';
+            out.write(row.data(), row.size());
+        }
+    });
+    return models;
+}
+
+// Packed binary table: the text header "PLTT 1 <n>\n", one line per variable
+// name, then the result column with one bit per row (row i is bit i % 8 of
+// byte i / 8). A 30-variable table is 128 MB.
+uint64_t writePackedTruthTable(Node* root, const vector<string>& varList, ostream& stream) {
+    int n = varList.size();
+    BufferedWriter out(stream);
+    out.write("PLTT 1 " + to_string(n) + "\n");
+    for (const string& v : varList) {
+        out.write(v + "\n");
+    }
+
+    CompiledFormula program = compileFormula(root, varList);
+    uint64_t mask = rowMask(n);
+    uint64_t row_bytes = n >= 3 ? (1ULL << n) / 8 : 1;
+    uint64_t models = 0;
+
+    forEachResultWindow(program, [&](uint64_t, const uint64_t* words, uint64_t count) {
+        char bytes[8];
+        for (uint64_t b = 0; b < count; ++b) {
+            uint64_t word = words[b] & mask;
+            models += popcount64(word);
+            for (int k = 0; k < 8; ++k) {
+                bytes[k] = static_cast<char>((word >> (8 * k)) & 0xFF);
+            }
+            out.write(bytes, min<uint64_t>(8, row_bytes));
+        }
+    });
+    return models;
+}
+
+// Prints the full truth table to the console followed by the model count.
+void printTruthTable(Node* root, const vector<string>& varList) {
+    uint64_t models = writeTruthTable(root, varList, cout);
+    printModelSummary(models, varList.size());
+}
+
+// --- Gray-Code Incremental Truth Tables ---
+// In Gray-code row order consecutive rows differ in exactly one variable.
+// The evaluator caches the value of every (hash-consed) node and, when a
+// variable flips, re-evaluates only the nodes above it, stopping wherever a
+// node's value does not change.
+class IncrementalEvaluator {
+public:
+    IncrementalEvaluator(Node* root, const vector<string>& varList) {
+        unordered_map<uint32_t, int> dense;
+        for (size_t i = 0; i < varList.size(); ++i) {
+            dense[symbols.intern(varList[i])] = static_cast<int>(i);
+        }
+        var_slot.assign(varList.size(), -1);
+        root_slot = addNodes(root, dense);
+
+        // Parent links in CSR form: parents of slot s are
+        // parents[parent_start[s] .. parent_start[s + 1]).
+        parent_start.assign(slots.size() + 1, 0);
+        for (const Slot& s : slots) {
+            if (s.left >= 0) parent_start[s.left + 1]++;
+            if (s.right >= 0 && s.right != s.left) parent_start[s.right + 1]++;
+        }
+        for (size_t s = 0; s < slots.size(); ++s) parent_start[s + 1] += parent_start[s];
+        parents.resize(parent_start.back());
+        vector<int> fill(parent_start.begin(), parent_start.end() - 1);
+        for (size_t s = 0; s < slots.size(); ++s) {
+            if (slots[s].left >= 0) parents[fill[slots[s].left]++] = s;
+            if (slots[s].right >= 0 && slots[s].right != slots[s].left) parents[fill[slots[s].right]++] = s;
+        }
+
+        // Every variable starts false; slots are in topological order.
+        value.assign(slots.size(), 0);
+        queued.assign(slots.size(), 0);
+        for (size_t s = 0; s < slots.size(); ++s) value[s] = compute(s);
+    }
+
+    void flip(int var) {
+        int s = var_slot[var];
+        if (s < 0) return;
+        value[s] = !value[s];
+        pushParents(s);
+        while (!pending.empty()) {
+            int p = pending.top();
+            pending.pop();
+            queued[p] = 0;
+            char v = compute(p);
+            if (v != value[p]) {
+                value[p] = v;
+                pushParents(p);
+            }
+        }
+    }
+
+    bool result() const { return value[root_slot]; }
+
+private:
+    struct Slot {
+        Op op;
+        int left;
+        int right;
+    };
+
+    // Numbers the distinct nodes children-first, so slots are in topological order.
+    int addNodes(Node* root, const unordered_map<uint32_t, int>& dense) {
+        unordered_map<const Node*, int> index;
+        forEachPostorder(root, [&](Node* node) {
+            Slot slot{node->op, -1, -1};
+            if (node->op != Op::Var) {
+                slot.left = index.at(node->left);
+                if (node->op != Op::Not) slot.right = index.at(node->right);
+            }
+            int id = slots.size();
+            slots.push_back(slot);
+            if (node->op == Op::Var) var_slot[dense.at(node->var)] = id;
+            index.emplace(node, id);
+        });
+        return index.at(root);
+    }
+
+    char compute(int s) const {
+        const Slot& slot = slots[s];
+        switch (slot.op) {
+            case Op::Var: return value[s];
+            case Op::Not: return !value[slot.left];
+            case Op::And: return value[slot.left] & value[slot.right];
+            case Op::Or: return value[slot.left] | value[slot.right];
+            case Op::Implies: return (!value[slot.left]) | value[slot.right];
+        }
+        return 0;
+    }
+
+    // Parents always have higher slot numbers than their children, so taking
+    // the lowest pending slot first evaluates each node after its inputs.
+    void pushParents(int s) {
+        for (int i = parent_start[s]; i < parent_start[s + 1]; ++i) {
+            int p = parents[i];
+            if (!queued[p]) {
+                queued[p] = 1;
+                pending.push(p);
+            }
+        }
+    }
+
+    vector<Slot> slots;
+    vector<char> value;
+    vector<char> queued;
+    vector<int> var_slot;
+    vector<int> parent_start;
+    vector<int> parents;
+    priority_queue<int, vector<int>, greater<int>> pending;
+    int root_slot;
+};
+
+// Writes the table in Gray-code row order: row r assigns the variables the
+// bits of r ^ (r >> 1), so each row flips exactly one variable of the last.
+uint64_t writeGrayCodeTruthTable(Node* root, const vector<string>& varList, ostream& stream) {
+    int n = varList.size();
+    BufferedWriter out(stream);
+    for (const string& v : varList) {
+        out.write(v + "\t");
+    }
+    out.write("Result\n");
+
+    IncrementalEvaluator evaluator(root, varList);
+    string row(2 * n + 2, '\t');
+    for (int j = 0; j < n; ++j) row[2 * j] = 'F';
+    row.back() = '\n';
+    uint64_t models = 0;
+
+    long long row_count = 1LL << n; 
+    for (long long r = 0; r < row_count; ++r) {
+        if (r > 0) {
+            int bit = 0;
+            while (!((r >> bit) & 1)) bit++;
+            int var = n - 1 - bit;
+            evaluator.flip(var);
+            row[2 * var] = (row[2 * var] == 'T') ? 'F' : 'T';
+        }
+        bool result = evaluator.result();
+        models += result;
+        row[2 * n] = result ? 'T' : 'F';
+        out.write(row.data(), row.size());
+    }
+    return models;
+}
+
+void printGrayCodeTruthTable(Node* root, const vector<string>& varList) {
+    uint64_t models = writeGrayCodeTruthTable(root, varList, cout);
+    printModelSummary(models, varList.size());
+}
+
+// Model count only; practical for 25-30 variables since no rows are printed.
+void printTruthTableSummary(Node* root, const vector<string>& varList) {
+    CompiledFormula program = compileFormula(root, varList);
+    cout << "Kernel: " << truthKernelName(truthKernel) << ", threads: " << threadCount << endl;
+
+    auto start = chrono::high_resolution_clock::now();
+    uint64_t models = countModels(program);
+    auto stop = chrono::high_resolution_clock::now();
+
+    printModelSummary(models, varList.size());
+    double seconds = chrono::duration<double>(stop - start).count();
+    cout << "Evaluated 2^" << varList.size() << " rows in " << seconds * 1000 << " ms";
+    if (seconds > 0) cout << " (" << (double)(1ULL << varList.size()) / seconds / 1e6 << " Mrows/s)";
+    cout << endl;
+}
+
+Node* impl_free(Node* root) {
+    unordered_map<Node*, Node*> rewritten{{nullptr, nullptr}};
+    forEachPostorder(root, [&](Node* node) {
+        if (node->op == Op::Var) {
+            rewritten[node] = node;
+            return;
+        }
+        Node* left = rewritten[node->left];
+        Node* right = rewritten[node->right];
+        if (node->op == Op::Implies) {
+            // A > B is logically equivalent to (~A + B)
+            rewritten[node] = mkNode(Op::Or, mkNode(Op::Not, left), right);
+        } else {
+            rewritten[node] = mkNode(node->op, left, right);
+        }
+    });
+    return rewritten[root];
 }
 
+// Pushes negations down to the variables. Each (subformula, negated) pair
+// is rewritten once, children first, from an explicit stack:
+//   ~(~A) -> A,  ~(A + B) -> ~A * ~B,  ~(A * B) -> ~A + ~B.
+// Implications (normally removed by impl_free first) are kept as they are.
 Node* nnf(Node* root) {
-    if (!root) return nullptr;
-    
-    // Base Case: Literal (or negated literal)
-    if (isOperand(root->data) || (root->data == "~" && isOperand(root->left->data))) return root;
+    unordered_map<Node*, Node*> rewritten[2]; // Indexed by "is negated"
+    rewritten[0][nullptr] = rewritten[1][nullptr] = nullptr;
+    vector<pair<Node*, bool>> pending{{root, false}};
+    while (!pending.empty()) {
+        auto [node, negated] = pending.back();
+        if (rewritten[negated].count(node)) {
+            pending.pop_back();
+            continue;
+        }
+        if (node->op == Op::Var) { // Base Case: Literal (or negated literal)
+            rewritten[negated][node] = negated ? mkNode(Op::Not, node) : node;
+            pending.pop_back();
+            continue;
+        }
+
+        // Operands are negated with their parent, except under a double
+        // negation or on either side of an implication.
+        bool operands_negated = (node->op == Op::Not) ? !negated : (node->op == Op::Implies ? false : negated);
+        auto& operands = rewritten[operands_negated];
+        bool ready = true;
+        if (!operands.count(node->right)) {
+            pending.push_back({node->right, operands_negated});
+            ready = false;
+        }
+        if (!operands.count(node->left)) {
+            pending.push_back({node->left, operands_negated});
+            ready = false;
+        }
+        if (!ready) continue;
+        pending.pop_back();
+
+        Node* left = operands[node->left];
+        Node* right = operands[node->right];
+        Node* result;
+        if (node->op == Op::Not) {
+            result = left;
+        } else if (node->op == Op::Implies) {
+            result = mkNode(Op::Implies, left, right);
+            if (negated) result = mkNode(Op::Not, result);
+        } else if (negated) { // De Morgan's Law
+            result = mkNode(node->op == Op::And ? Op::Or : Op::And, left, right);
+        } else {
+            result = mkNode(node->op, left, right);
+        }
+        rewritten[negated][node] = result;
+    }
+    return rewritten[0][root];
+}
+
+// Memo tables for one cnf() call. Nodes are hash-consed, so a rewrite of the
+// same node (or the same pair of nodes) always yields the same result.
+struct PairHash {
+    size_t operator()(const pair<Node*, Node*>& p) const {
+        size_t h = reinterpret_cast<uintptr_t>(p.first) * 0x9E3779B97F4A7C15ULL;
+        return h ^ (reinterpret_cast<uintptr_t>(p.second) + 0x9E3779B97F4A7C15ULL + (h << 6) + (h >> 2));
+    }
+};
+
+struct CnfCache {
+    unordered_map<Node*, Node*> converted;
+    unordered_map<pair<Node*, Node*>, Node*, PairHash> distributed;
+};
+
+// Builds the CNF of (a + b) where a and b are already in CNF. Every pair
+// is distributed once, children first, from an explicit stack.
+Node* distribute(Node* a, Node* b, CnfCache& cache) {
+    vector<pair<Node*, Node*>> pending{{a, b}};
+    while (!pending.empty()) {
+        pair<Node*, Node*> current = pending.back();
+        if (cache.distributed.count(current)) {
+            pending.pop_back();
+            continue;
+        }
+        auto [x, y] = current;
+        pair<Node*, Node*> first, second;
+        if (x->op == Op::And) { // Distributive Law: (A * B) + C -> (A + C) * (B + C)
+            first = {x->left, y};
+            second = {x->right, y};
+        } else if (y->op == Op::And) { // Distributive Law: C + (A * B) -> (C + A) * (C + B)
+            first = {x, y->left};
+            second = {x, y->right};
+        } else {
+            cache.distributed.emplace(current, mkNode(Op::Or, x, y));
+            pending.pop_back();
+            continue;
+        }
+        auto left = cache.distributed.find(first);
+        auto right = cache.distributed.find(second);
+        if (left == cache.distributed.end() || right == cache.distributed.end()) {
+            if (right == cache.distributed.end()) pending.push_back(second);
+            if (left == cache.distributed.end()) pending.push_back(first);
+            continue;
+        }
+        Node* result = mkNode(Op::And, left->second, right->second);
+        cache.distributed.emplace(current, result);
+        pending.pop_back();
+    }
+    return cache.distributed.at({a, b});
+}
+
+// Expects NNF input (see nnf()), so negations only wrap variables.
+Node* cnf(Node* root) {
+    CnfCache cache;
+    cache.converted[nullptr] = nullptr;
+    forEachPostorder(root, [&](Node* node) {
+        Node* result = node; // Literals are already in CNF
+        if (node->op != Op::Var && node->op != Op::Not) {
+            Node* left = cache.converted[node->left];
+            Node* right = cache.converted[node->right];
+            result = (node->op == Op::Or) ? distribute(left, right, cache) : mkNode(node->op, left, right);
+        }
+        cache.converted[node] = result;
+    });
+    return cache.converted[root];
+}
+
+// NNF/CNF display: binary operators are always parenthesised, negations
+// around anything but a variable.
+void printInfixFromTree(Node* root) {
+    string infix;
+    appendInfix(root, infix, true);
+    cout << infix;
+}
+
+DimacsCNF readDIMACSCNF(const string& dimacsInput, int& numVars, int& numClauses) {
+    DimacsCNF formula;
+    stringstream ss(dimacsInput);
+    string line;
+    numVars = 0;
+    numClauses = 0;
+    bool p_line_found = false;
+
+    while (getline(ss, line)) {
+        if (line.empty() || line[0] == 'c') continue; 
+        
+        if (line[0] == 'p') {
+            stringstream ps(line.substr(1));
+            string type;
+            if (!(ps >> type >> numVars >> numClauses) || type != "cnf") {
+                cerr << "Error: Invalid or missing 'p cnf' line." << endl;
+                return {};
+            }
+            p_line_found = true;
+            continue;
+        }
+        
+        if (!p_line_found) continue;
+
+        stringstream cs(line);
+        Literal lit;
+        Clause currentClause;
+        bool clause_ended = true;
+
+        while (cs >> lit) {
+            if (lit == 0) {
+                if (!currentClause.empty() || clause_ended == false) {
+                     formula.push_back(currentClause);
+                }
+                currentClause.clear();
+                clause_ended = true;
+            } else {
+                currentClause.push_back(lit);
+                clause_ended = false;
+            }
+        }
+    }
+    return formula;
+}
+
+// --- Streaming DIMACS Reader ---
+// Skips to the character after the next newline.
+inline const char* skipLine(const char* p, const char* end) {
+    const char* nl = static_cast<const char*>(memchr(p, '\n', end - p));
+    return nl ? nl + 1 : end;
+}
+
+// Incremental DIMACS parser: feed() accepts the input in chunks split at
+// arbitrary bytes and calls onClause for every completed clause, so nothing
+// but the current clause is kept. Clauses may span lines; a SATLIB '%'
+// end marker at the start of a line stops parsing. Like readDIMACSCNF,
+// empty clauses are ignored and anything before the 'p cnf' line is skipped.
+class DimacsStreamParser {
+public:
+    using ClauseFn = function<void(const Clause&)>;
+    using HeaderFn = function<void(int numVars, int numClauses)>;
+
+    explicit DimacsStreamParser(ClauseFn clauseFn, HeaderFn headerFn = nullptr)
+        : onClause(move(clauseFn)), onHeader(move(headerFn)) {}
+
+    // Returns false (with a message on cerr) on malformed input.
+    bool feed(const char* p, size_t size) {
+        const char* end = p + size;
+        while (p < end && ok) {
+            switch (state) {
+                case State::Between: {
+                    unsigned char ch = *p;
+                    if (ch <= ' ') {
+                        line_start |= ch == '\n';
+                        ++p;
+                    } else if (ch == 'c') {
+                        state = State::SkipLine;
+                    } else if (ch == 'p') {
+                        header_line.clear();
+                        state = State::Header;
+                        ++p;
+                    } else if (ch == '%' && line_start) {
+                        state = State::Done;
+                    } else if (!header_seen || (ch != '-' && (unsigned)(ch - '0') > 9)) {
+                        state = State::SkipLine; // Not a literal: ignore the rest of the line
+                    } else {
+                        negative = ch == '-';
+                        p += negative;
+                        value = 0;
+                        digits = 0;
+                        line_start = false;
+                        state = State::Number;
+                    }
+                    break;
+                }
+                case State::SkipLine: {
+                    const char* next = skipLine(p, end);
+                    if (next[-1] == '\n') {
+                        state = State::Between;
+                        line_start = true;
+                    }
+                    p = next;
+                    break;
+                }
+                case State::Header: {
+                    const char* next = skipLine(p, end);
+                    header_line.append(p, next);
+                    p = next;
+                    if (next[-1] == '\n') {
+                        parseHeader();
+                        state = State::Between;
+                        line_start = true;
+                    }
+                    break;
+                }
+                case State::Number: {
+                    while (p < end && (unsigned)(*p - '0') <= 9 && value <= INT32_MAX) {
+                        value = value * 10 + (*p++ - '0');
+                        digits++;
+                    }
+                    if (p < end) endNumber();
+                    break;
+                }
+                case State::Done:
+                    return ok;
+            }
+        }
+        return ok;
+    }
+
+    // Ends the input, flushing a final number or clause without its 0.
+    bool finish() {
+        if (state == State::Number) endNumber();
+        if (state == State::Header) parseHeader();
+        if (ok && !current.empty()) onClause(current);
+        current.clear();
+        state = State::Done;
+        return ok;
+    }
+
+    int numVars() const { return num_vars; }
+    int numClauses() const { return num_clauses; }
+
+    // For parsing a clause section split off after the header was read.
+    void assumeHeader(int numVars, int numClauses) {
+        num_vars = numVars;
+        num_clauses = numClauses;
+        header_seen = true;
+    }
+
+private:
+    enum class State { Between, SkipLine, Header, Number, Done };
+
+    void parseHeader() {
+        stringstream ps(header_line);
+        string type;
+        if (!(ps >> type >> num_vars >> num_clauses) || type != "cnf") {
+            cerr << "Error: Invalid or missing 'p cnf' line." << endl;
+            ok = false;
+            return;
+        }
+        header_seen = true;
+        if (onHeader) onHeader(num_vars, num_clauses);
+    }
+
+    void endNumber() {
+        state = State::Between;
+        if (digits == 0 || value > INT32_MAX) {
+            cerr << "Error: Invalid literal in DIMACS input." << endl;
+            ok = false;
+        } else if (value == 0) {
+            if (!current.empty()) onClause(current);
+            current.clear();
+        } else {
+            current.push_back(negative ? -(Literal)value : (Literal)value);
+        }
+    }
+
+    ClauseFn onClause;
+    HeaderFn onHeader;
+    State state = State::Between;
+    bool line_start = true;
+    bool ok = true;
+    bool header_seen = false;
+    string header_line;
+    bool negative = false;
+    uint64_t value = 0;
+    int digits = 0;
+    Clause current;
+    int num_vars = 0;
+    int num_clauses = 0;
+};
+
+// Fixed-capacity blocking queue; close() wakes every waiter and makes
+// push() fail, while pop() still drains what is left.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : limit(capacity) {}
+
+    bool push(T item) {
+        unique_lock<mutex> guard(lock);
+        not_full.wait(guard, [&] { return closed || items.size() < limit; });
+        if (closed) return false;
+        items.push_back(move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    bool pop(T& item) {
+        unique_lock<mutex> guard(lock);
+        not_empty.wait(guard, [&] { return closed || !items.empty(); });
+        if (items.empty()) return false;
+        item = move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    void close() {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+    mutex lock;
+    condition_variable not_full, not_empty;
+    deque<T> items;
+    size_t limit;
+    bool closed = false;
+};
+
+// Feeds `in` to the parser in chunks of `chunkSize` bytes. A reader thread
+// fills a small ring of `depth` buffers while this thread parses, so I/O
+// overlaps with parsing and memory stays at depth * chunkSize.
+bool streamDIMACS(istream& in, DimacsStreamParser& parser, size_t chunkSize = 1 << 20, size_t depth = 4) {
+    BoundedQueue<vector<char>> empty(depth), full(depth);
+    for (size_t i = 0; i < depth; ++i) empty.push(vector<char>(chunkSize));
+
+    thread reader([&]() {
+        vector<char> buffer;
+        while (empty.pop(buffer)) {
+            buffer.resize(chunkSize);
+            in.read(buffer.data(), chunkSize);
+            buffer.resize(in.gcount());
+            if (buffer.empty() || !full.push(move(buffer))) break;
+        }
+        full.close();
+    });
+
+    bool ok = true;
+    vector<char> chunk;
+    while (full.pop(chunk)) {
+        if (!parser.feed(chunk.data(), chunk.size())) {
+            ok = false;
+            break;
+        }
+        empty.push(move(chunk));
+    }
+    empty.close();
+    full.close();
+    reader.join();
+    return ok && parser.finish();
+}
+
+// --- Memory-Mapped DIMACS Loader ---
+// Read-only view of a whole file: mmap on POSIX systems, a heap copy
+// elsewhere (Windows builds read the file instead).
+class MappedFile {
+public:
+    explicit MappedFile(const string& path) {
+#ifdef PLT_POSIX_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            length = st.st_size;
+            opened = true;
+            if (length > 0) {
+                void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    opened = false;
+                } else {
+                    madvise(p, length, MADV_SEQUENTIAL);
+                    ptr = static_cast<const char*>(p);
+                    mapped = true;
+                }
+            }
+        }
+        close(fd);
+#else
+        ifstream file(path, ios::binary);
+        if (!file) return;
+        fallback.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+        ptr = fallback.data();
+        length = fallback.size();
+        opened = true;
+#endif
+    }
+
+    ~MappedFile() {
+#ifdef PLT_POSIX_MMAP
+        if (mapped) munmap(const_cast<char*>(ptr), length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool ok() const { return opened; }
+    const char* data() const { return ptr; }
+    size_t size() const { return length; }
+
+private:
+    const char* ptr = nullptr;
+    size_t length = 0;
+    bool opened = false;
+    bool mapped = false;
+    string fallback;
+};
+
+// --- Parallel DIMACS Parsing ---
+// True if [line, eol) is a complete clause line: its last token is "0" and
+// it is not a comment. A range starting after such a line starts on a
+// clause boundary.
+bool endsClauseLine(const char* line, const char* eol) {
+    while (line < eol && (*line == ' ' || *line == '\t')) ++line;
+    if (line == eol || *line == 'c') return false;
+    while (eol > line && (unsigned char)eol[-1] <= ' ') --eol;
+    return eol > line && eol[-1] == '0' && (eol - 1 == line || (unsigned char)eol[-2] <= ' ');
+}
+
+// Cuts the clause section [body, end) into at most `parts` ranges, each
+// starting on a clause boundary. Boundaries are found by moving from the
+// ideal split point to the next line that ends a clause.
+vector<pair<const char*, const char*>> splitDIMACSBody(const char* body, const char* end, size_t parts) {
+    vector<pair<const char*, const char*>> ranges;
+    const char* start = body;
+    for (size_t k = 1; k < parts && start < end; ++k) {
+        const char* cut = max(start, body + (end - body) * k / parts);
+        cut = skipLine(cut, end); // Only whole lines are tested
+        while (cut < end) {
+            const char* eol = skipLine(cut, end);
+            if (endsClauseLine(cut, eol)) {
+                cut = eol;
+                break;
+            }
+            cut = eol;
+        }
+        if (cut >= end) break;
+        ranges.push_back({start, cut});
+        start = cut;
+    }
+    ranges.push_back({start, end});
+    return ranges;
+}
+
+// End of the clause section: the SATLIB '%' marker at the start of a line.
+// `p` must be at a line start.
+const char* findDIMACSEnd(const char* p, const char* end) {
+    const char* begin = p;
+    while (p < end) {
+        const char* hit = static_cast<const char*>(memchr(p, '%', end - p));
+        if (!hit) break;
+        const char* q = hit;
+        while (q > begin && (q[-1] == ' ' || q[-1] == '\t')) --q;
+        if (q == begin || q[-1] == '\n') return hit;
+        p = hit + 1;
+    }
+    return end;
+}
+
+// Parses a whole DIMACS text on `threads` workers. The header is read
+// first; the clause section is then split at clause boundaries and each
+// range is handed to its own DimacsStreamParser whose clauses go to
+// sinkFor(range index). Inputs below minRange bytes per range are not split.
+bool parseDIMACSParallel(const char* p, const char* end, unsigned threads, int& numVars, int& numClauses,
+                         size_t& ranges_used, const function<DimacsStreamParser::ClauseFn(size_t)>& sinkFor,
+                         size_t minRange = 1 << 22) {
+    numVars = 0;
+    numClauses = 0;
+
+    // Header: everything up to and including the 'p' line.
+    const char* body = p;
+    while (body < end) {
+        const char* line = body;
+        while (line < end && (unsigned char)*line <= ' ') ++line;
+        if (line == end) {
+            body = end;
+            break;
+        }
+        body = skipLine(line, end);
+        if (*line == 'p') break;
+    }
+    DimacsStreamParser header([](const Clause&) {});
+    if (!header.feed(p, body - p) || !header.finish()) return false;
+    numVars = header.numVars();
+    numClauses = header.numClauses();
+    if (body >= end) {
+        ranges_used = 0;
+        return true; // No header, or nothing after it: no clauses
+    }
+
+    end = findDIMACSEnd(body, end);
+    size_t parts = threads <= 1 ? 1 : min<size_t>(threads * 4, (end - body) / minRange + 1);
+    vector<pair<const char*, const char*>> ranges = splitDIMACSBody(body, end, parts);
+    ranges_used = ranges.size();
+
+    atomic<bool> ok{true};
+    parallelForChunks(ranges.size(), 1, threads, [&](uint64_t first, uint64_t, unsigned) {
+        DimacsStreamParser parser(sinkFor(first));
+        parser.assumeHeader(numVars, numClauses);
+        const auto& range = ranges[first];
+        if (!parser.feed(range.first, range.second - range.first) || !parser.finish()) ok = false;
+    });
+    return ok;
+}
+
+// Parses a whole in-memory DIMACS text (for example a mapped file) on
+// `threads` workers. Each range fills its own DimacsCNF; the parts are then
+// concatenated in order with block copies.
+bool parseDIMACSBuffer(const char* p, const char* end, DimacsCNF& formula, int& numVars, int& numClauses,
+                       unsigned threads = threadCount) {
+    formula.clear();
+    vector<DimacsCNF> parts(max<size_t>(1, threads * 4));
+    size_t used = 0;
+    bool ok = parseDIMACSParallel(p, end, threads, numVars, numClauses, used, [&](size_t part) {
+        return [&parts, part](const Clause& clause) { parts[part].push_back(clause); };
+    });
+    if (used == 1) {
+        formula.swap(parts[0]);
+    } else {
+        for (size_t i = 0; i < used; ++i) formula.append(parts[i]);
+    }
+    return ok;
+}
+
+// --- Binary CNF Cache ---
+// Re-checking the same large instance should not re-parse its text every
+// time. A cache file stores the DimacsCNF CSR arrays verbatim after a fixed
+// header, so loading it is one mmap and a checksum pass:
+//
+//   CnfCacheHeader (48 bytes)
+//   uint64_t offsets[num_clauses + 1]   clause i is lits[offsets[i] .. offsets[i + 1])
+//   int32_t  lits[num_literals]
+//
+// Literals are fixed-width rather than varint-encoded so the mapped bytes
+// can be handed out as ClauseViews directly. Integers are in the writer's
+// byte order; endian_tag lets a reader on another machine reject the file.
+const char kCnfCacheMagic[4] = {'P', 'L', 'T', 'C'};
+const uint32_t kCnfCacheVersion = 1;
+const uint32_t kCnfCacheEndianTag = 0x01020304;
+
+struct CnfCacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t endian_tag;
+    int32_t num_vars;       // From the 'p cnf' line
+    int32_t header_clauses; // From the 'p cnf' line
+    uint32_t reserved;
+    uint64_t num_clauses;   // Clauses actually stored
+    uint64_t num_literals;
+    uint64_t checksum;      // cnfChecksum over offsets, then literals
+};
+static_assert(sizeof(CnfCacheHeader) == 48, "cache header layout must not change within a version");
+static_assert(sizeof(Literal) == 4, "cache literals are 32-bit");
+
+// 64-bit checksum over a byte range, chained through `seed`. Four
+// independent multiply-rotate lanes keep it well ahead of the page cache.
+// visit(word) sees every 8-byte word of the whole 32-byte blocks, so callers
+// can inspect the data in the same pass; the last `bytes % 32` are not visited.
+template <typename WordFn>
+uint64_t cnfChecksum(const void* data, size_t bytes, uint64_t seed, WordFn visit) {
+    const uint64_t k1 = 0x9E3779B185EBCA87ULL, k2 = 0xC2B2AE3D27D4EB4FULL;
+    auto round = [&](uint64_t acc, uint64_t word) {
+        acc += word * k2;
+        acc = (acc << 31) | (acc >> 33);
+        return acc * k1;
+    };
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    uint64_t lane[4] = {seed + k1 + k2, seed + k2, seed, seed - k1};
+    size_t i = 0;
+    for (; i + 32 <= bytes; i += 32) {
+        for (int l = 0; l < 4; ++l) {
+            uint64_t word;
+            memcpy(&word, p + i + 8 * l, 8);
+            visit(word);
+            lane[l] = round(lane[l], word);
+        }
+    }
+    uint64_t h = bytes;
+    for (int l = 0; l < 4; ++l) h = round(h, lane[l]);
+    for (; i < bytes; ++i) h = round(h, p[i]);
+    h ^= h >> 29;
+    h *= k1;
+    return h ^ (h >> 32);
+}
+
+uint64_t cnfChecksum(const void* data, size_t bytes, uint64_t seed) {
+    return cnfChecksum(data, bytes, seed, [](uint64_t) {});
+}
+
+// True for the literal values no clause may hold: 0 (the DIMACS clause
+// terminator) and INT_MIN (which has no negation). Both have all bits but
+// the sign clear.
+inline bool isCorruptLiteral(uint32_t bits) {
+    return (bits & 0x7FFFFFFFu) == 0;
+}
+
+bool hasCnfCacheMagic(const char* data, size_t size) {
+    return size >= sizeof(kCnfCacheMagic) && memcmp(data, kCnfCacheMagic, sizeof(kCnfCacheMagic)) == 0;
+}
+
+// Writes `formula` as a cache file. Returns false (with a message on cerr)
+// if the file cannot be written.
+bool writeCnfCache(const string& path, CnfView formula, int numVars, int numClauses) {
+    const uint64_t* offsets = formula.offsets();
+    const Literal* lits = formula.literals();
+    size_t offset_bytes = (formula.size() + 1) * sizeof(uint64_t);
+    size_t lit_bytes = formula.literalCount() * sizeof(Literal);
+
+    CnfCacheHeader header{};
+    memcpy(header.magic, kCnfCacheMagic, sizeof(header.magic));
+    header.version = kCnfCacheVersion;
+    header.endian_tag = kCnfCacheEndianTag;
+    header.num_vars = numVars;
+    header.header_clauses = numClauses;
+    header.num_clauses = formula.size();
+    header.num_literals = formula.literalCount();
+    header.checksum = cnfChecksum(lits, lit_bytes, cnfChecksum(offsets, offset_bytes, kCnfCacheVersion));
+
+    ofstream out(path, ios::binary | ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(offsets), offset_bytes);
+    out.write(reinterpret_cast<const char*>(lits), lit_bytes);
+    out.close();
+    if (!out) {
+        cerr << "Error: Could not write '" << path << "'." << endl;
+        return false;
+    }
+    return true;
+}
+
+// A mapped cache file. view() points straight into the mapping, so it is
+// valid only while this object lives. With `verify` the checksum is
+// recomputed on open; the offset table is always bounds-checked.
+class CnfCacheFile {
+public:
+    explicit CnfCacheFile(const string& path, bool verify = true) : file(path) {
+        if (!file.ok()) {
+            error_ = "could not read file";
+            return;
+        }
+        const char* data = file.data();
+        size_t size = file.size();
+        if (size < sizeof(CnfCacheHeader) || !hasCnfCacheMagic(data, size)) {
+            error_ = "not a binary CNF cache";
+            return;
+        }
+        memcpy(&header, data, sizeof(header));
+        if (header.endian_tag != kCnfCacheEndianTag) {
+            error_ = "written on a machine with different byte order";
+            return;
+        }
+        if (header.version != kCnfCacheVersion) {
+            error_ = "unsupported cache version " + to_string(header.version);
+            return;
+        }
+        size_t payload = size - sizeof(CnfCacheHeader);
+        if (header.num_clauses >= payload / sizeof(uint64_t) ||
+            header.num_literals > (payload - (header.num_clauses + 1) * sizeof(uint64_t)) / sizeof(Literal) ||
+            payload != (header.num_clauses + 1) * sizeof(uint64_t) + header.num_literals * sizeof(Literal)) {
+            error_ = "truncated or oversized file";
+            return;
+        }
+        offsets = reinterpret_cast<const uint64_t*>(data + sizeof(CnfCacheHeader));
+        lits = reinterpret_cast<const Literal*>(offsets + header.num_clauses + 1);
+
+        bool ordered = offsets[0] == 0 && offsets[header.num_clauses] == header.num_literals;
+        for (uint64_t i = 0; ordered && i < header.num_clauses; ++i) ordered = offsets[i] <= offsets[i + 1];
+        if (!ordered) {
+            error_ = "corrupt clause offsets";
+            return;
+        }
+        // Literals are range-checked in the checksum pass (or alone without
+        // verification), so a bad value never reaches a solver's index math.
+        bool corrupt = false;
+        uint64_t sum = 0;
+        size_t checked = 0;
+        if (verify) {
+            size_t offset_bytes = (header.num_clauses + 1) * sizeof(uint64_t);
+            sum = cnfChecksum(offsets, offset_bytes, kCnfCacheVersion);
+            sum = cnfChecksum(lits, header.num_literals * sizeof(Literal), sum, [&](uint64_t word) {
+                corrupt |= isCorruptLiteral(static_cast<uint32_t>(word)) | isCorruptLiteral(static_cast<uint32_t>(word >> 32));
+            });
+            checked = header.num_literals / 8 * 8; // Whole 32-byte blocks
+        }
+        for (size_t i = checked; i < header.num_literals; ++i) corrupt |= isCorruptLiteral(static_cast<uint32_t>(lits[i]));
+        if (corrupt) {
+            error_ = "corrupt literals";
+            return;
+        }
+        if (verify && sum != header.checksum) {
+            error_ = "checksum mismatch";
+            return;
+        }
+        valid = true;
+    }
+
+    bool ok() const { return valid; }
+    const string& error() const { return error_; }
+    size_t bytes() const { return file.size(); }
+    int numVars() const { return header.num_vars; }
+    int numClauses() const { return header.header_clauses; }
+    CnfView view() const { return CnfView(lits, offsets, valid ? header.num_clauses : 0); }
+
+private:
+    MappedFile file;
+    CnfCacheHeader header{};
+    uint64_t empty_offset = 0; // Backs view() of a file that failed to open
+    const uint64_t* offsets = &empty_offset;
+    const Literal* lits = nullptr;
+    bool valid = false;
+    string error_;
+};
+
+// Loads a DIMACS CNF file through a memory mapping; binary cache files
+// (see writeCnfCache) are recognised by their magic and copied in instead of
+// parsed. Returns false (with a message on cerr) if the file cannot be read
+// or parsed.
+bool readDIMACSFile(const string& path, DimacsCNF& formula, int& numVars, int& numClauses,
+                    size_t* bytes = nullptr) {
+    formula.clear();
+    numVars = 0;
+    numClauses = 0;
+    MappedFile file(path);
+    if (!file.ok()) {
+        cerr << "Error: Could not read '" << path << "'." << endl;
+        return false;
+    }
+    if (bytes) *bytes = file.size();
+    if (hasCnfCacheMagic(file.data(), file.size())) {
+        CnfCacheFile cache(path);
+        if (!cache.ok()) {
+            cerr << "Error: '" << path << "': " << cache.error() << "." << endl;
+            return false;
+        }
+        DimacsCNF(cache.view()).swap(formula);
+        numVars = cache.numVars();
+        numClauses = cache.numClauses();
+        return true;
+    }
+    return parseDIMACSBuffer(file.data(), file.data() + file.size(), formula, numVars, numClauses);
+}
+
+// True for a DIMACS clause line: integers separated by whitespace.
+bool isDimacsClauseLine(const string& line) {
+    bool has_digit = false;
+    for (char c : line) {
+        if (isdigit((unsigned char)c)) has_digit = true;
+        else if (c != '-' && !isspace((unsigned char)c)) return false;
+    }
+    return has_digit;
+}
+
+enum class DimacsSource { PASTED, FILE, UNREADABLE };
+
+// Prompt shared by the interactive DIMACS options. A first line that is a
+// comment, problem or clause line starts pasted input, and `pasted` holds the
+// lines up to the first blank one. Anything else names a file: FILE with
+// `path` set if it can be opened, otherwise UNREADABLE after an error on cerr
+// (a mistyped path must not silently become an empty formula).
+DimacsSource promptDIMACSInput(string& path, string& pasted) {
+    cout << "\nEnter DIMACS CNF input (paste lines, finish with a blank line), or a file path: \n";
+    string first, line;
+    getline(cin, first);
+    bool dimacs_line = !first.empty() && (first[0] == 'c' || first[0] == 'p') &&
+                       (first.size() == 1 || isspace((unsigned char)first[1]));
+    if (!first.empty() && !dimacs_line && !isDimacsClauseLine(first)) {
+        if (!ifstream(first)) { // Only probe here; the reader maps the file once
+            cerr << "Error: Could not read '" << first << "'." << endl;
+            return DimacsSource::UNREADABLE;
+        }
+        path = first;
+        return DimacsSource::FILE;
+    }
+    pasted = first.empty() ? "" : first + "\n";
+    while (!first.empty() && getline(cin, line) && !line.empty()) {
+        pasted += line + "\n";
+    }
+    return DimacsSource::PASTED;
+}
+
+// Reads a formula through promptDIMACSInput. Returns false (after an error
+// on cerr) if the named file cannot be read or parsed.
+bool readDIMACSFromUser(DimacsCNF& formula, int& numVars, int& numClauses) {
+    string path, pasted;
+    DimacsSource source = promptDIMACSInput(path, pasted);
+    if (source == DimacsSource::UNREADABLE) return false;
+    if (source == DimacsSource::PASTED) {
+        formula = readDIMACSCNF(pasted, numVars, numClauses);
+        return true;
+    }
+
+    auto start = chrono::high_resolution_clock::now();
+    size_t bytes = 0;
+    if (!readDIMACSFile(path, formula, numVars, numClauses, &bytes)) return false;
+    double secs = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cout << "Loaded " << formula.size() << " clauses from '" << path << "' (" << bytes / 1e6 << " MB in "
+         << secs * 1000 << " ms, " << bytes / 1e6 / max(secs, 1e-9) << " MB/s)." << endl;
+    return true;
+}
+
+// Finds complementary literal pairs without allocating. Short clauses are
+// compared pairwise; longer ones stamp each variable with the current
+// generation and the literal's sign in a reusable array, so a clause costs
+// one pass and the array is never cleared between clauses.
+class TautologyDetector {
+public:
+    bool isTautology(ClauseView clause) {
+        if (clause.size() <= kPairwiseLimit) {
+            for (size_t i = 1; i < clause.size(); ++i) {
+                for (size_t j = 0; j < i; ++j) {
+                    if (clause[i] == -clause[j]) return true;
+                }
+            }
+            return false;
+        }
+        if (++generation == kGenerationLimit) {
+            fill(stamps.begin(), stamps.end(), 0);
+            generation = 1;
+        }
+        for (Literal lit : clause) {
+            uint32_t var = magnitude(lit);
+            uint32_t mark = (generation << 1) | (lit < 0);
+            if (var >= kMaxStampedVar) return hasComplementBySorting(clause);
+            if (var >= stamps.size()) stamps.resize(min<size_t>(max<size_t>(var + 1, stamps.size() * 2), kMaxStampedVar), 0);
+            uint32_t seen = stamps[var];
+            if ((seen >> 1) == generation && seen != mark) return true; // Clause contains a complementary pair
+            stamps[var] = mark;
+        }
+        return false;
+    }
+
+private:
+    static uint32_t magnitude(Literal lit) {
+        return lit < 0 ? 0u - static_cast<uint32_t>(lit) : static_cast<uint32_t>(lit);
+    }
+
+    // Fallback for clauses naming variables above the stamp cap: sort a
+    // scratch copy by (variable, sign) so complementary literals end up adjacent.
+    bool hasComplementBySorting(ClauseView clause) {
+        scratch.assign(clause.begin(), clause.end());
+        sort(scratch.begin(), scratch.end(), [](Literal a, Literal b) {
+            uint32_t va = magnitude(a), vb = magnitude(b);
+            return va != vb ? va < vb : a < b;
+        });
+        for (size_t i = 1; i < scratch.size(); ++i) {
+            if (scratch[i] != scratch[i - 1] && magnitude(scratch[i]) == magnitude(scratch[i - 1])) return true;
+        }
+        return false;
+    }
+
+    static const size_t kPairwiseLimit = 8;
+    static const uint32_t kGenerationLimit = 1u << 31;
+    static const uint32_t kMaxStampedVar = 1u << 22; // Bounds stamps at 16 MB per thread
+    vector<uint32_t> stamps;
+    vector<Literal> scratch;
+    uint32_t generation = 0;
+};
+
+bool is_dimacs_clause_true(ClauseView clause) {
+    thread_local TautologyDetector detector;
+    return detector.isTautology(clause);
+}
+
+// Counts the tautological clauses of `formula` on `threads` workers, each
+// with its own counter.
+uint64_t count_tautologies(CnfView formula, unsigned threads = threadCount) {
+    struct alignas(64) WorkerCount {
+        uint64_t tautologies = 0;
+    };
+    vector<WorkerCount> counts(max(1u, threads));
+    parallelForChunks(formula.size(), 1 << 14, threads, [&](uint64_t first, uint64_t count, unsigned worker) {
+        uint64_t found = 0;
+        for (uint64_t i = first; i < first + count; ++i) found += is_dimacs_clause_true(formula[i]);
+        counts[worker].tautologies += found;
+    });
+    uint64_t tautologies = 0;
+    for (const WorkerCount& c : counts) tautologies += c.tautologies;
+    return tautologies;
+}
+
+bool check_dimacs_valid_formula(CnfView formula) {
+    uint64_t tautologies = count_tautologies(formula);
+    uint64_t count_false = formula.size() - tautologies;
+    cout << "Number of non-tautology clauses: " << count_false << endl;
+    cout << "Number of tautology clauses: " << tautologies << endl;
+    return count_false == 0; 
+}
+
+// Constant-memory counterpart of check_dimacs_valid_formula: clauses are
+// checked as they stream in and never stored. Returns false on a parse error.
+bool count_dimacs_tautologies(istream& in, int& numVars, int& numClauses,
+                              uint64_t& clauses, uint64_t& tautologies) {
+    clauses = 0;
+    tautologies = 0;
+    DimacsStreamParser parser([&](const Clause& clause) {
+        clauses++;
+        tautologies += is_dimacs_clause_true(clause);
+    });
+    bool ok = streamDIMACS(in, parser);
+    numVars = parser.numVars();
+    numClauses = parser.numClauses();
+    return ok;
+}
+
+// Same count over an in-memory text (a mapped file), parsed in parallel
+// ranges; each range only keeps two counters, so nothing is stored.
+bool count_dimacs_tautologies(const char* p, const char* end, int& numVars, int& numClauses,
+                              uint64_t& clauses, uint64_t& tautologies) {
+    struct alignas(64) RangeCount {
+        uint64_t clauses = 0;
+        uint64_t tautologies = 0;
+    };
+    vector<RangeCount> counts(max(1u, threadCount) * 4);
+    size_t used = 0;
+    bool ok = parseDIMACSParallel(p, end, threadCount, numVars, numClauses, used, [&](size_t range) {
+        return [&counts, range](const Clause& clause) {
+            counts[range].clauses++;
+            counts[range].tautologies += is_dimacs_clause_true(clause);
+        };
+    });
+    clauses = 0;
+    tautologies = 0;
+    for (size_t i = 0; i < used; ++i) {
+        clauses += counts[i].clauses;
+        tautologies += counts[i].tautologies;
+    }
+    return ok;
+}
+
+// Tautology count for a DIMACS file or binary cache without storing the
+// formula; "-" streams DIMACS text from stdin. Returns false (with a message
+// on cerr) if the input cannot be read or parsed.
+bool count_file_tautologies(const string& path, int& numVars, int& numClauses,
+                            uint64_t& clauses, uint64_t& tautologies, size_t* bytes = nullptr) {
+    numVars = numClauses = 0;
+    clauses = tautologies = 0;
+    if (bytes) *bytes = 0;
+    if (path == "-") return count_dimacs_tautologies(cin, numVars, numClauses, clauses, tautologies);
+
+    MappedFile file(path);
+    if (!file.ok()) {
+        cerr << "Error: Could not read '" << path << "'." << endl;
+        return false;
+    }
+    if (bytes) *bytes = file.size();
+    if (!hasCnfCacheMagic(file.data(), file.size())) {
+        return count_dimacs_tautologies(file.data(), file.data() + file.size(), numVars, numClauses,
+                                        clauses, tautologies);
+    }
+    CnfCacheFile cache(path);
+    if (!cache.ok()) {
+        cerr << "Error: '" << path << "': " << cache.error() << "." << endl;
+        return false;
+    }
+    numVars = cache.numVars();
+    numClauses = cache.numClauses();
+    clauses = cache.view().size();
+    tautologies = count_tautologies(cache.view());
+    return true;
+}
+
+// Collects the clauses of a CNF parse tree as DIMACS literals (symbol ID + 1,
+// negated for ~x) in one pass over the tree. Returns false if the tree is not
+// a conjunction of disjunctions of literals.
+bool extractCnfClauses(Node* root, DimacsCNF& clauses) {
+    clauses.clear();
+    Clause literals; // Scratch buffer for the clause being collected
+    vector<Node*> conjuncts{root};
+    vector<Node*> disjuncts;
+    while (!conjuncts.empty()) {
+        Node* node = conjuncts.back();
+        conjuncts.pop_back();
+        if (!node) return false;
+        if (node->op == Op::And) {
+            conjuncts.push_back(node->right);
+            conjuncts.push_back(node->left);
+            continue;
+        }
+
+        literals.clear();
+        disjuncts.assign(1, node);
+        while (!disjuncts.empty()) {
+            Node* d = disjuncts.back();
+            disjuncts.pop_back();
+            if (!d) return false;
+            if (d->op == Op::Or) {
+                disjuncts.push_back(d->right);
+                disjuncts.push_back(d->left);
+            } else if (d->op == Op::Var) {
+                literals.push_back(d->var + 1);
+            } else if (d->op == Op::Not && d->left && d->left->op == Op::Var) {
+                literals.push_back(-(Literal)(d->left->var + 1));
+            } else {
+                return false;
+            }
+        }
+        clauses.append(literals.begin(), literals.end());
+    }
+    return true;
+}
+
+enum class CnfValidity { VALID, NOT_VALID, NOT_CNF }; // NOT_CNF: no verdict
+
+// Validity of an infix CNF formula: every clause must contain a
+// complementary pair. Works on the parse tree, so any parenthesisation of
+// the clauses is accepted. Input that is not in CNF (including empty input)
+// is reported on cout and gets NOT_CNF rather than a verdict.
+CnfValidity check_cnf_valid(const string& cnf_formula) {
+    Node* root = buildParseTree(infixToPrefix(cnf_formula));
+    DimacsCNF clauses;
+    bool is_cnf = extractCnfClauses(root, clauses);
+    releaseTree();
+    if (!is_cnf) {
+        cout << "Error: The formula is not in CNF (a conjunction of disjunctions of literals)." << endl;
+        return CnfValidity::NOT_CNF;
+    }
+    return all_of(clauses.begin(), clauses.end(), is_dimacs_clause_true) ? CnfValidity::VALID
+                                                                         : CnfValidity::NOT_VALID;
+}
+
+string dimacsToInfix(CnfView formula) {
+    if (formula.empty()) return "";
+
+    stringstream infix_ss;
+    for (size_t i = 0; i < formula.size(); ++i) {
+        const auto& clause = formula[i];
+        if (clause.empty()) continue;
+
+        infix_ss << "(";
+        for (size_t j = 0; j < clause.size(); ++j) {
+            Literal lit = clause[j];
+            
+            // P-notation is used for variables (P1, P2, ...)
+            if (lit < 0) {
+                infix_ss << "~P" << -lit;
+            } else {
+                infix_ss << "P" << lit;
+            }
+            if (j < clause.size() - 1) {
+                infix_ss << " + ";
+            }
+        }
+        infix_ss << ")";
+
+        if (i < formula.size() - 1) {
+            infix_ss << " * ";
+        }
+    }
+    return infix_ss.str();
+}
+
+// --- Tseitin / Plaisted-Greenbaum Encoding ---
+// Equisatisfiable CNF built in one pass over the parse tree. Every operator
+// node gets a fresh DIMACS variable x plus the clauses of x <-> (a op b), so
+// the output is linear in formula size instead of exponential. Shared
+// (hash-consed) subformulas are defined only once.
+//
+// In polarity-aware (Plaisted-Greenbaum) mode only the implication direction
+// a subformula actually needs is emitted: x -> (a op b) where it occurs
+// positively, (a op b) -> x where it occurs negatively, both under an
+// equivalence. The result is still equisatisfiable with fewer clauses.
+enum Polarity : uint8_t { POSITIVE = 1, NEGATIVE = 2, BOTH = 3 };
+
+Polarity flip(Polarity pol) {
+    return static_cast<Polarity>(((pol & POSITIVE) << 1) | ((pol & NEGATIVE) >> 1));
+}
+
+class TseitinEncoder {
+public:
+    // Input variables of the formula are numbered 1..k in name order and
+    // auxiliary variables follow; varNames receives the k input names.
+    TseitinEncoder(Node* root, DimacsCNF& out, vector<string>& varNames, bool polarity_aware)
+        : clauses(out), next_var(1), use_polarity(polarity_aware) {
+        set<string> vars;
+        getVariables(root, vars);
+        varNames.assign(vars.begin(), vars.end());
+        for (const string& name : varNames) {
+            input_vars[symbols.intern(name)] = next_var++;
+        }
+    }
+
+    // Returns the literal standing for `root`, emitting the definitions it
+    // needs. Subformulas are encoded children first from an explicit stack;
+    // variables are numbered and clauses emitted in the same order as a
+    // left-to-right recursive encoding would.
+    Literal encode(Node* root, Polarity pol = POSITIVE) {
+        struct Frame {
+            Node* node;
+            Polarity missing; // Polarities this visit defines
+            int sign;         // -1 when reached through an odd number of negations
+            Literal var;
+            Literal left;
+            int stage;        // Operands encoded so far
+        };
+        vector<Frame> pending;
+        Literal result = 0; // Literal of the most recently finished subformula
+
+        // Resolves the literal of (node, pol) into `result` and returns true,
+        // or pushes a frame for a definition still to be emitted.
+        auto visit = [&](Node* node, Polarity pol) {
+            int sign = 1;
+            while (node->op == Op::Not) {
+                node = node->left;
+                sign = -sign;
+                pol = flip(pol);
+            }
+            if (!use_polarity) pol = BOTH;
+            if (node->op == Op::Var) {
+                result = sign * input_vars.at(node->var);
+                return true;
+            }
+            Definition& def = defined[node];
+            if (def.var == 0) def.var = next_var++;
+            Polarity missing = static_cast<Polarity>(pol & ~def.emitted);
+            if (missing == 0) {
+                result = sign * def.var;
+                return true;
+            }
+            def.emitted = static_cast<Polarity>(def.emitted | missing);
+            pending.push_back({node, missing, sign, def.var, 0, 0});
+            return false;
+        };
+
+        if (visit(root, pol)) return result;
+        while (true) {
+            Frame& frame = pending.back();
+            if (frame.stage == 0) {
+                frame.stage = 1;
+                // The left operand of an implication occurs with flipped polarity.
+                Polarity left_pol = (frame.node->op == Op::Implies) ? flip(frame.missing) : frame.missing;
+                if (!visit(frame.node->left, left_pol)) continue;
+            }
+            if (frame.stage == 1) {
+                frame.left = result;
+                frame.stage = 2;
+                if (!visit(frame.node->right, frame.missing)) continue;
+            }
+            define(frame.node->op, frame.var, frame.missing, frame.left, result);
+            result = frame.sign * frame.var;
+            pending.pop_back();
+            if (pending.empty()) return result;
+        }
+    }
+
+    int numVars() const { return next_var - 1; }
+
+private:
+    struct Definition {
+        Literal var = 0;
+        Polarity emitted = static_cast<Polarity>(0);
+    };
+
+    // Emits the clauses of x <-> (a op b) for the polarities in `missing`.
+    void define(Op op, Literal x, Polarity missing, Literal a, Literal b) {
+        bool pos = missing & POSITIVE;
+        bool neg = missing & NEGATIVE;
+        switch (op) {
+            case Op::And: // x <-> (a * b)
+                if (pos) { clauses.push_back({-x, a}); clauses.push_back({-x, b}); }
+                if (neg) { clauses.push_back({x, -a, -b}); }
+                break;
+            case Op::Or: // x <-> (a + b)
+                if (pos) { clauses.push_back({-x, a, b}); }
+                if (neg) { clauses.push_back({x, -a}); clauses.push_back({x, -b}); }
+                break;
+            case Op::Implies: // x <-> (~a + b)
+                if (pos) { clauses.push_back({-x, -a, b}); }
+                if (neg) { clauses.push_back({x, a}); clauses.push_back({x, -b}); }
+                break;
+            default:
+                throw runtime_error("Unknown operator in tree.");
+        }
+    }
+
+    DimacsCNF& clauses;
+    Literal next_var;
+    bool use_polarity;
+    unordered_map<uint32_t, Literal> input_vars;
+    unordered_map<const Node*, Definition> defined;
+};
+
+DimacsCNF definitionalCNF(Node* root, int& numVars, vector<string>& varNames, bool polarity_aware) {
+    DimacsCNF formula;
+    numVars = 0;
+    varNames.clear();
+    if (!root) return formula;
+
+    TseitinEncoder encoder(root, formula, varNames, polarity_aware);
+    Literal top = encoder.encode(root);
+    formula.push_back({top});
+    numVars = encoder.numVars();
+    return formula;
+}
+
+DimacsCNF tseitinCNF(Node* root, int& numVars, vector<string>& varNames) {
+    return definitionalCNF(root, numVars, varNames, false);
+}
+
+DimacsCNF plaistedGreenbaumCNF(Node* root, int& numVars, vector<string>& varNames) {
+    return definitionalCNF(root, numVars, varNames, true);
+}
+
+size_t countLiterals(CnfView formula) {
+    size_t total = 0;
+    for (const auto& clause : formula) total += clause.size();
+    return total;
+}
+
+// One-line size comparison of the two definitional encodings of a formula.
+void printEncodingStats(Node* root) {
+    int tseitinVars, pgVars;
+    vector<string> names;
+    DimacsCNF tseitin = tseitinCNF(root, tseitinVars, names);
+    DimacsCNF pg = plaistedGreenbaumCNF(root, pgVars, names);
+    cout << "Stats: Tseitin " << tseitin.size() << " clauses / " << countLiterals(tseitin) << " literals"
+         << ", Plaisted-Greenbaum " << pg.size() << " clauses / " << countLiterals(pg) << " literals" << endl;
+}
+
+// Writes a formula in DIMACS format. Named variables are listed in comment
+// lines first so the encoding can be mapped back to the original formula.
+string dimacsToString(CnfView formula, int numVars, const vector<string>& varNames) {
+    stringstream out;
+    for (size_t i = 0; i < varNames.size(); ++i) {
+        out << "c " << varNames[i] << " = " << i + 1 << "\n";
+    }
+    out << "p cnf " << numVars << " " << formula.size() << "\n";
+    for (const auto& clause : formula) {
+        for (Literal lit : clause) {
+            out << lit << " ";
+        }
+        out << "0\n";
+    }
+    return out.str();
+}
+
+// --- DPLL Satisfiability ---
+enum class SatResult { SAT, UNSAT, UNKNOWN }; // UNKNOWN: search was cancelled
+
+// Highest variable index used by the clauses (the header count may be wrong).
+int maxVariable(CnfView formula, int numVars) {
+    int highest = max(numVars, 0);
+    for (const auto& clause : formula) {
+        for (Literal lit : clause) highest = max(highest, abs(lit));
+    }
+    return highest;
+}
+
+bool verifyModel(CnfView formula, const vector<char>& model) {
+    for (const auto& clause : formula) {
+        bool satisfied = false;
+        for (Literal lit : clause) {
+            if (model[abs(lit)] == (lit > 0)) { satisfied = true; break; }
+        }
+        if (!satisfied) return false;
+    }
+    return true;
+}
+
+// Classic DPLL: unit propagation, pure-literal elimination and chronological
+// backtracking over an explicit trail (no recursion).
+class DPLLSolver {
+public:
+    DPLLSolver(CnfView cnf, int numVars)
+        : formula(cnf), num_vars(maxVariable(cnf, numVars)),
+          value(num_vars + 1, 0), occurrences(2 * (num_vars + 1)),
+          true_count(cnf.size(), 0), open_count(2 * (num_vars + 1), 0) {
+        for (size_t c = 0; c < formula.size(); ++c) {
+            for (Literal lit : formula[c]) occurrences[index(lit)].push_back(c);
+        }
+        for (size_t i = 0; i < occurrences.size(); ++i) open_count[i] = occurrences[i].size();
+        // Every variable is checked for purity once at the root.
+        for (int v = 1; v <= num_vars; ++v) pure_candidates.push_back(v);
+        order.resize(num_vars);
+        for (int v = 1; v <= num_vars; ++v) order[v - 1] = v;
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return occurrences[index(a)].size() + occurrences[index(-a)].size() >
+                   occurrences[index(b)].size() + occurrences[index(-b)].size();
+        });
+    }
+
+    // model[v] is 0/1 for v in 1..numVars when the result is SAT.
+    SatResult solve(vector<char>& model) {
+        for (const auto& clause : formula) {
+            if (clause.empty()) return SatResult::UNSAT;
+            if (clause.size() == 1 && !assign(clause[0])) return SatResult::UNSAT;
+        }
+
+        while (true) {
+            if (!propagate()) {
+                if (!backtrack()) return SatResult::UNSAT;
+                continue;
+            }
+            assignPureLiterals();
+            if (!propagate()) {
+                if (!backtrack()) return SatResult::UNSAT;
+                continue;
+            }
+
+            int var = pickBranchVariable();
+            if (var == 0) break;
+            decisions.push_back({trail.size(), -var, false});
+            assign(-var);
+            decision_count++;
+        }
+
+        model.assign(num_vars + 1, 0);
+        for (int v = 1; v <= num_vars; ++v) model[v] = value[v] > 0;
+        return SatResult::SAT;
+    }
+
+    uint64_t decisionCount() const { return decision_count; }
+    uint64_t propagationCount() const { return propagation_count; }
+
+private:
+    struct Decision {
+        size_t trail_start;
+        Literal lit;
+        bool flipped;
+    };
+
+    static size_t index(Literal lit) { return 2 * abs(lit) + (lit < 0); }
+
+    // +1 true, -1 false, 0 unassigned
+    int litValue(Literal lit) const {
+        int v = value[abs(lit)];
+        return lit > 0 ? v : -v;
+    }
+
+    bool assign(Literal lit) {
+        int current = litValue(lit);
+        if (current != 0) return current > 0;
+        value[abs(lit)] = lit > 0 ? 1 : -1;
+        trail.push_back(lit);
+        for (size_t c : occurrences[index(lit)]) {
+            if (true_count[c]++ == 0) {
+                for (Literal l : formula[c]) countOpen(l, -1);
+            }
+        }
+        return true;
+    }
+
+    void unassign(Literal lit) {
+        value[abs(lit)] = 0;
+        for (size_t c : occurrences[index(lit)]) {
+            if (--true_count[c] == 0) {
+                for (Literal l : formula[c]) countOpen(l, +1);
+            }
+        }
+    }
+
+    // Adjusts the number of unsatisfied clauses containing `lit`. Purity of
+    // a variable can only change when one of its counts reaches or leaves
+    // zero, so only then is it queued for assignPureLiterals().
+    void countOpen(Literal lit, int delta) {
+        size_t& count = open_count[index(lit)];
+        if (count == 0 || count + delta == 0) pure_candidates.push_back(abs(lit));
+        count += delta;
+    }
+
+    // Visits the clauses that contain the negation of each newly assigned
+    // literal; a clause with no true and one unassigned literal forces it.
+    bool propagate() {
+        while (propagated < trail.size()) {
+            Literal falsified = -trail[propagated++];
+            propagation_count++;
+            for (size_t c : occurrences[index(falsified)]) {
+                Literal unassigned = 0;
+                int open = 0;
+                bool satisfied = false;
+                for (Literal lit : formula[c]) {
+                    int v = litValue(lit);
+                    if (v > 0) { satisfied = true; break; }
+                    if (v == 0) { open++; unassigned = lit; }
+                }
+                if (satisfied) continue;
+                if (open == 0) return false;
+                if (open == 1) assign(unassigned);
+            }
+        }
+        return true;
+    }
+
+    // A variable that occurs with only one sign in the clauses that are not
+    // yet satisfied can be set to satisfy all of them. The per-literal
+    // counts are kept up to date by assign()/unassign(), so only variables
+    // whose counts crossed zero since the last call are examined.
+    void assignPureLiterals() {
+        while (!pure_candidates.empty()) {
+            int v = pure_candidates.back();
+            pure_candidates.pop_back();
+            if (value[v] != 0) continue;
+            size_t pos = open_count[index(v)], neg = open_count[index(-v)];
+            if (pos && !neg) assign(v);
+            else if (neg && !pos) assign(-v);
+        }
+    }
+
+    int pickBranchVariable() {
+        for (int v : order) {
+            if (value[v] == 0) return v;
+        }
+        return 0;
+    }
+
+    // Undoes the trail back to the most recent decision that has not yet
+    // been tried both ways and flips it. Returns false when none is left.
+    bool backtrack() {
+        while (!decisions.empty()) {
+            Decision d = decisions.back();
+            while (trail.size() > d.trail_start) {
+                unassign(trail.back());
+                trail.pop_back();
+            }
+            propagated = trail.size();
+            decisions.pop_back();
+            if (!d.flipped) {
+                decisions.push_back({trail.size(), -d.lit, true});
+                assign(-d.lit);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    CnfView formula;
+    int num_vars;
+    vector<int> value;
+    vector<vector<size_t>> occurrences;
+    vector<uint32_t> true_count;  // Per clause: literals currently true
+    vector<size_t> open_count;    // Per literal: unsatisfied clauses containing it
+    vector<int> pure_candidates;  // Variables whose purity may have changed
+    vector<int> order;
+    vector<Literal> trail;
+    size_t propagated = 0;
+    vector<Decision> decisions;
+    uint64_t decision_count = 0;
+    uint64_t propagation_count = 0;
+};
+
+SatResult solveDPLL(CnfView formula, int numVars, vector<char>& model) {
+    DPLLSolver solver(formula, numVars);
+    return solver.solve(model);
+}
+
+// Prints the result in the SAT competition format ("s ..." and "v ... 0").
+void printSatResult(SatResult result, const vector<char>& model) {
+    if (result == SatResult::UNSAT) {
+        cout << "s UNSATISFIABLE" << endl;
+        return;
+    }
+    if (result == SatResult::UNKNOWN) {
+        cout << "s UNKNOWN" << endl;
+        return;
+    }
+    cout << "s SATISFIABLE" << endl;
+    cout << "v";
+    for (size_t v = 1; v < model.size(); ++v) {
+        cout << " " << (model[v] ? (long long)v : -(long long)v);
+    }
+    cout << " 0" << endl;
+}
+
+// --- CDCL Satisfiability ---
+// Conflict-driven clause learning for large DIMACS instances: two-watched-
+// literal propagation, EVSIDS branching with phase saving, first-UIP
+// learning with recursive clause minimisation, Luby or glucose-style
+// (LBD moving average) restarts, and periodic reduction of the learned
+// clause database by LBD and activity.
+struct CdclConfig {
+    enum RestartPolicy { LUBY, GLUCOSE };
+    RestartPolicy restarts = GLUCOSE;
+    int luby_unit = 100;              // Conflicts per Luby unit
+    double var_decay = 0.95;          // EVSIDS decay
+    double clause_decay = 0.999;
+    bool initial_phase = false;       // Polarity tried first for fresh variables
+    uint32_t seed = 0;                // Non-zero: perturb initial activities
+    double random_var_freq = 0;       // Fraction of decisions on a random variable
+    uint64_t first_reduce = 2000;     // Conflicts before the first DB reduction
+    uint64_t reduce_increment = 300;
+};
+
+struct CdclStats {
+    uint64_t conflicts = 0;
+    uint64_t decisions = 0;
+    uint64_t propagations = 0;
+    uint64_t restarts = 0;
+    uint64_t learned = 0;
+    uint64_t deleted = 0;
+    uint64_t exported = 0;
+    uint64_t imported = 0;
+    double seconds = 0;
+};
+
+class CDCLSolver {
+public:
+    // Hooks for cooperating solvers. Clauses cross the boundary as DIMACS
+    // literals; imports happen at decision level 0 (start and restarts).
+    using ExportFn = function<bool(const vector<Literal>& clause, uint32_t lbd)>;
+    using ImportFn = function<void(vector<vector<Literal>>& clauses)>;
+
+    CDCLSolver(CnfView formula, int numVars, const CdclConfig& cfg = CdclConfig())
+        : config(cfg), num_vars(maxVariable(formula, numVars)),
+          assigns(num_vars, 0), level(num_vars, 0), reason(num_vars, NO_REASON),
+          polarity(num_vars, cfg.initial_phase ? 0 : 1), seen(num_vars, 0),
+          activity(num_vars, 0.0), heap_index(num_vars, -1), level_stamp(num_vars + 1, 0),
+          watches(2 * num_vars) {
+        next_reduce = cfg.first_reduce;
+        rng_state = cfg.seed * 2654435761u + 1;
+        for (int v = 0; v < num_vars; ++v) {
+            if (cfg.seed != 0) activity[v] = (nextRandom() % 1000) * 1e-5;
+            heapInsert(v);
+        }
+
+        vector<Lit> lits;
+        for (const auto& clause : formula) {
+            lits.clear();
+            for (Literal d : clause) lits.push_back(toLit(d));
+            if (!addInputClause(lits)) {
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    // model[v] is 0/1 for DIMACS variables v in 1..numVars when SAT. With
+    // assumptions, UNSAT means unsatisfiable under those literals; learned
+    // clauses are kept, so the solver can be called again with other ones.
+    SatResult solve(vector<char>& model, const vector<Literal>& assumptions = {}) {
+        auto start = chrono::high_resolution_clock::now();
+        assumed.clear();
+        for (Literal d : assumptions) {
+            if (abs(d) <= num_vars) assumed.push_back(toLit(d));
+        }
+        SatResult result = search();
+        stats_.seconds += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        if (result == SatResult::SAT) {
+            model.assign(num_vars + 1, 0);
+            for (int v = 0; v < num_vars; ++v) model[v + 1] = assigns[v] > 0;
+        }
+        cancelUntil(0);
+        return result;
+    }
+
+    // Lookahead primitives for the cube splitter: assign lit at a new
+    // decision level and propagate. On conflict the level is undone and false
+    // is returned; otherwise `implied` counts the literals it assigned.
+    bool assume(Literal lit, size_t& implied) {
+        size_t before = trail.size();
+        trail_lim.push_back(before);
+        Lit l = toLit(lit);
+        if (value(l) == 0) enqueue(l, NO_REASON);
+        else if (value(l) < 0) {
+            cancelUntil(decisionLevel() - 1);
+            return false;
+        }
+        if (propagate() != NO_REASON) {
+            cancelUntil(decisionLevel() - 1);
+            return false;
+        }
+        implied = trail.size() - before;
+        return true;
+    }
+
+    void undoAssume() { cancelUntil(decisionLevel() - 1); }
+
+    // False once the clauses are known to be UNSAT without assumptions.
+    bool consistent() const { return ok; }
+
+    // +1 true, -1 false, 0 unassigned under the current assumptions.
+    int literalValue(Literal lit) const { return value(toLit(lit)); }
+
+    const CdclStats& stats() const { return stats_; }
+
+    // solve() returns UNKNOWN soon after *flag becomes true.
+    void setCancelFlag(const atomic<bool>* flag) { cancel = flag; }
+    // Called for every learned clause; returns true if the clause was taken.
+    void setClauseExport(ExportFn fn) { export_clause = move(fn); }
+    // Called at level 0 to fetch clauses learned elsewhere.
+    void setClauseImport(ImportFn fn) { import_clauses = move(fn); }
+
+private:
+    // Internal literal: 2 * var + sign, var 0-based; sign 1 means negated.
+    using Lit = uint32_t;
+    using CRef = uint32_t;
+    static constexpr CRef NO_REASON = 0xFFFFFFFFu;
+
+    // Clause literals live in one flat arena (the same CSR layout as
+    // DimacsCNF); a clause records where its literals start.
+    struct SolverClause {
+        size_t offset = 0;
+        uint32_t size = 0;
+        uint32_t lbd = 0;
+        float activity = 0;
+        bool learnt = false;
+        bool removed = false;
+    };
+
+    struct Watch {
+        CRef cref;
+        Lit blocker; // Another literal of the clause; if true the clause is skipped
+    };
+
+    static Lit toLit(Literal d) { return 2 * (abs(d) - 1) + (d < 0); }
+    static int var(Lit l) { return l >> 1; }
+    static Lit neg(Lit l) { return l ^ 1; }
+
+    // +1 true, -1 false, 0 unassigned
+    int value(Lit l) const {
+        int v = assigns[var(l)];
+        return (l & 1) ? -v : v;
+    }
+
+    int decisionLevel() const { return trail_lim.size(); }
+
+    bool addInputClause(vector<Lit>& lits) {
+        sort(lits.begin(), lits.end());
+        size_t j = 0;
+        for (size_t i = 0; i < lits.size(); ++i) {
+            if (value(lits[i]) > 0 || (j > 0 && lits[i] == neg(lits[j - 1]))) return true; // satisfied / tautology
+            if (value(lits[i]) < 0 || (j > 0 && lits[i] == lits[j - 1])) continue;
+            lits[j++] = lits[i];
+        }
+        lits.resize(j);
+        if (lits.empty()) return false;
+        if (lits.size() == 1) {
+            enqueue(lits[0], NO_REASON);
+            return propagate() == NO_REASON;
+        }
+        attachClause(newClause(lits, false, 0));
+        return true;
+    }
+
+    CRef newClause(const vector<Lit>& lits, bool learnt, uint32_t lbd) {
+        CRef cref;
+        if (!free_slots.empty()) {
+            cref = free_slots.back();
+            free_slots.pop_back();
+        } else {
+            cref = clauses.size();
+            clauses.emplace_back();
+        }
+        SolverClause& c = clauses[cref];
+        c.offset = arena.size();
+        c.size = lits.size();
+        arena.insert(arena.end(), lits.begin(), lits.end());
+        c.lbd = lbd;
+        c.activity = 0;
+        c.learnt = learnt;
+        c.removed = false;
+        if (learnt) learnts.push_back(cref);
+        return cref;
+    }
+
+    Lit* litsOf(CRef cref) { return arena.data() + clauses[cref].offset; }
+    const Lit* litsOf(CRef cref) const { return arena.data() + clauses[cref].offset; }
+
+    void attachClause(CRef cref) {
+        const Lit* lits = litsOf(cref);
+        watches[lits[0]].push_back({cref, lits[1]});
+        watches[lits[1]].push_back({cref, lits[0]});
+    }
+
+    void enqueue(Lit l, CRef from) {
+        int v = var(l);
+        assigns[v] = (l & 1) ? -1 : 1;
+        level[v] = decisionLevel();
+        reason[v] = from;
+        trail.push_back(l);
+    }
+
+    // Two-watched-literal unit propagation. Returns the conflicting clause,
+    // or NO_REASON when every assignment on the trail has been propagated.
+    CRef propagate() {
+        CRef conflict = NO_REASON;
+        while (qhead < trail.size()) {
+            Lit false_lit = neg(trail[qhead++]);
+            stats_.propagations++;
+            vector<Watch>& ws = watches[false_lit];
+            size_t i = 0, j = 0;
+            while (i < ws.size()) {
+                Watch w = ws[i++];
+                if (value(w.blocker) > 0) {
+                    ws[j++] = w;
+                    continue;
+                }
+                Lit* lits = litsOf(w.cref);
+                size_t size = clauses[w.cref].size;
+                if (lits[0] == false_lit) swap(lits[0], lits[1]);
+                Lit first = lits[0];
+                if (first != w.blocker && value(first) > 0) {
+                    ws[j++] = {w.cref, first};
+                    continue;
+                }
+
+                bool moved = false;
+                for (size_t k = 2; k < size; ++k) {
+                    if (value(lits[k]) >= 0) {
+                        swap(lits[1], lits[k]);
+                        watches[lits[1]].push_back({w.cref, first});
+                        moved = true;
+                        break;
+                    }
+                }
+                if (moved) continue;
+
+                ws[j++] = {w.cref, first};
+                if (value(first) < 0) {
+                    conflict = w.cref;
+                    qhead = trail.size();
+                    while (i < ws.size()) ws[j++] = ws[i++];
+                } else {
+                    enqueue(first, w.cref);
+                }
+            }
+            ws.resize(j);
+        }
+        return conflict;
+    }
+
+    // --- EVSIDS ---
+    void heapInsert(int v) {
+        heap_index[v] = heap.size();
+        heap.push_back(v);
+        heapUp(heap_index[v]);
+    }
+
+    void heapUp(int i) {
+        int v = heap[i];
+        while (i > 0) {
+            int parent = (i - 1) / 2;
+            if (activity[heap[parent]] >= activity[v]) break;
+            heap[i] = heap[parent];
+            heap_index[heap[i]] = i;
+            i = parent;
+        }
+        heap[i] = v;
+        heap_index[v] = i;
+    }
+
+    void heapDown(int i) {
+        int v = heap[i];
+        int n = heap.size();
+        while (2 * i + 1 < n) {
+            int child = 2 * i + 1;
+            if (child + 1 < n && activity[heap[child + 1]] > activity[heap[child]]) child++;
+            if (activity[heap[child]] <= activity[v]) break;
+            heap[i] = heap[child];
+            heap_index[heap[i]] = i;
+            i = child;
+        }
+        heap[i] = v;
+        heap_index[v] = i;
+    }
+
+    int heapPop() {
+        int top = heap[0];
+        heap_index[top] = -1;
+        int last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            heap_index[last] = 0;
+            heapDown(0);
+        }
+        return top;
+    }
+
+    void bumpVariable(int v) {
+        activity[v] += var_inc;
+        if (activity[v] > 1e100) {
+            for (double& a : activity) a *= 1e-100;
+            var_inc *= 1e-100;
+        }
+        if (heap_index[v] >= 0) heapUp(heap_index[v]);
+    }
+
+    void bumpClause(SolverClause& c) {
+        c.activity += clause_inc;
+        if (c.activity > 1e20) {
+            for (CRef cr : learnts) clauses[cr].activity *= 1e-20f;
+            clause_inc *= 1e-20;
+        }
+    }
+
+    void cancelUntil(int target) {
+        if (decisionLevel() <= target) return;
+        for (size_t i = trail.size(); i > trail_lim[target]; --i) {
+            int v = var(trail[i - 1]);
+            polarity[v] = trail[i - 1] & 1;
+            assigns[v] = 0;
+            reason[v] = NO_REASON;
+            if (heap_index[v] < 0) heapInsert(v);
+        }
+        trail.resize(trail_lim[target]);
+        trail_lim.resize(target);
+        qhead = trail.size();
+    }
+
+    uint32_t abstractLevel(int v) const { return 1u << (level[v] & 31); }
+
+    // True when p is implied by literals already in the learned clause, so it
+    // can be dropped. Walks reason clauses with an explicit stack.
+    bool litRedundant(Lit p, uint32_t abstract_levels) {
+        analyze_stack.clear();
+        analyze_stack.push_back(p);
+        size_t top = analyze_toclear.size();
+        while (!analyze_stack.empty()) {
+            CRef from = reason[var(analyze_stack.back())];
+            analyze_stack.pop_back();
+            const Lit* lits = litsOf(from);
+            for (size_t i = 1; i < clauses[from].size; ++i) {
+                Lit q = lits[i];
+                int u = var(q);
+                if (seen[u] || level[u] == 0) continue;
+                if (reason[u] != NO_REASON && (abstractLevel(u) & abstract_levels)) {
+                    seen[u] = 1;
+                    analyze_stack.push_back(q);
+                    analyze_toclear.push_back(q);
+                } else {
+                    for (size_t k = top; k < analyze_toclear.size(); ++k) seen[var(analyze_toclear[k])] = 0;
+                    analyze_toclear.resize(top);
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // First-UIP conflict analysis. Fills `learnt` (asserting literal first,
+    // highest remaining level second) and returns the backjump level.
+    int analyze(CRef conflict, vector<Lit>& learnt, uint32_t& lbd) {
+        learnt.clear();
+        learnt.push_back(0);
+        int path_count = 0;
+        Lit p = 0;
+        bool have_p = false;
+        size_t index = trail.size();
+
+        do {
+            SolverClause& c = clauses[conflict];
+            if (c.learnt) bumpClause(c);
+            const Lit* lits = litsOf(conflict);
+            for (size_t j = have_p ? 1 : 0; j < c.size; ++j) {
+                Lit q = lits[j];
+                int v = var(q);
+                if (seen[v] || level[v] == 0) continue;
+                bumpVariable(v);
+                seen[v] = 1;
+                if (level[v] >= decisionLevel()) path_count++;
+                else learnt.push_back(q);
+            }
+            while (!seen[var(trail[--index])]) {}
+            p = trail[index];
+            have_p = true;
+            conflict = reason[var(p)];
+            seen[var(p)] = 0;
+            path_count--;
+        } while (path_count > 0);
+        learnt[0] = neg(p);
+
+        // Recursive minimisation: drop literals implied by the others.
+        analyze_toclear.assign(learnt.begin(), learnt.end());
+        uint32_t abstract_levels = 0;
+        for (size_t i = 1; i < learnt.size(); ++i) abstract_levels |= abstractLevel(var(learnt[i]));
+        size_t j = 1;
+        for (size_t i = 1; i < learnt.size(); ++i) {
+            if (reason[var(learnt[i])] == NO_REASON || !litRedundant(learnt[i], abstract_levels)) {
+                learnt[j++] = learnt[i];
+            }
+        }
+        learnt.resize(j);
+        for (Lit l : analyze_toclear) seen[var(l)] = 0;
+
+        int backjump = 0;
+        if (learnt.size() > 1) {
+            size_t max_i = 1;
+            for (size_t i = 2; i < learnt.size(); ++i) {
+                if (level[var(learnt[i])] > level[var(learnt[max_i])]) max_i = i;
+            }
+            swap(learnt[1], learnt[max_i]);
+            backjump = level[var(learnt[1])];
+        }
+
+        if (level_stamp.size() <= (size_t)decisionLevel()) level_stamp.resize(decisionLevel() + 1, 0);
+        stamp++;
+        lbd = 0;
+        for (Lit l : learnt) {
+            int lv = level[var(l)];
+            if (level_stamp[lv] != stamp) {
+                level_stamp[lv] = stamp;
+                lbd++;
+            }
+        }
+        return backjump;
+    }
+
+    static double luby(double y, uint64_t x) {
+        uint64_t size = 1;
+        int seq = 0;
+        while (size < x + 1) {
+            seq++;
+            size = 2 * size + 1;
+        }
+        while (size - 1 != x) {
+            size = (size - 1) >> 1;
+            seq--;
+            x = x % size;
+        }
+        return pow(y, seq);
+    }
+
+    bool shouldRestart() const {
+        if (config.restarts == CdclConfig::LUBY) {
+            return conflicts_since_restart >= luby(2, stats_.restarts) * config.luby_unit;
+        }
+        // Glucose-style: restart when recent learned clauses are clearly worse
+        // (higher LBD) than the long-term average.
+        return conflicts_since_restart >= 50 && lbd_fast * 0.8 > lbd_slow;
+    }
+
+    bool locked(CRef cref) const {
+        Lit first = litsOf(cref)[0];
+        return reason[var(first)] == cref && value(first) > 0;
+    }
+
+    // Deletes the less useful half of the learned clauses (high LBD, low
+    // activity). Glue clauses (LBD <= 2) and current reasons are kept.
+    void reduceDB() {
+        vector<CRef> candidates;
+        vector<CRef> kept;
+        for (CRef cr : learnts) {
+            const SolverClause& c = clauses[cr];
+            if (c.lbd <= 2 || locked(cr)) kept.push_back(cr);
+            else candidates.push_back(cr);
+        }
+        sort(candidates.begin(), candidates.end(), [&](CRef a, CRef b) {
+            if (clauses[a].lbd != clauses[b].lbd) return clauses[a].lbd > clauses[b].lbd;
+            return clauses[a].activity < clauses[b].activity;
+        });
+        size_t remove_count = candidates.size() / 2;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (i < remove_count) {
+                SolverClause& c = clauses[candidates[i]];
+                c.removed = true;
+                wasted += c.size;
+                stats_.deleted++;
+            } else {
+                kept.push_back(candidates[i]);
+            }
+        }
+        learnts.swap(kept);
+
+        for (vector<Watch>& ws : watches) {
+            ws.erase(remove_if(ws.begin(), ws.end(), [&](const Watch& w) { return clauses[w.cref].removed; }),
+                     ws.end());
+        }
+        for (size_t i = 0; i < remove_count; ++i) free_slots.push_back(candidates[i]);
+        if (wasted > arena.size() / 2) compactArena();
+    }
+
+    // Moves live clauses to a fresh arena; CRefs (and so watches and
+    // reasons) stay valid because only offsets change.
+    void compactArena() {
+        vector<Lit> packed;
+        packed.reserve(arena.size() - wasted);
+        for (SolverClause& c : clauses) {
+            if (c.removed) continue;
+            size_t offset = packed.size();
+            packed.insert(packed.end(), arena.begin() + c.offset, arena.begin() + c.offset + c.size);
+            c.offset = offset;
+        }
+        arena.swap(packed);
+        wasted = 0;
+    }
+
+    uint32_t nextRandom() {
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 17;
+        rng_state ^= rng_state << 5;
+        return rng_state;
+    }
+
+    bool cancelled() const { return cancel && cancel->load(memory_order_relaxed); }
+
+    // Adds clauses from import_clauses at level 0, simplified against the
+    // root assignment. Returns false if one of them is falsified there.
+    bool importClauses() {
+        if (!import_clauses) return true;
+        imported_buffer.clear();
+        import_clauses(imported_buffer);
+        vector<Lit> lits;
+        for (const auto& clause : imported_buffer) {
+            lits.clear();
+            bool satisfied = false;
+            for (Literal d : clause) {
+                if (abs(d) > num_vars) {
+                    satisfied = true; // Unknown variable: cannot be ours
+                    break;
+                }
+                Lit l = toLit(d);
+                if (value(l) > 0) satisfied = true;
+                else if (value(l) == 0) lits.push_back(l);
+            }
+            if (satisfied) continue;
+            stats_.imported++;
+            if (lits.empty()) return false;
+            if (lits.size() == 1) {
+                enqueue(lits[0], NO_REASON);
+            } else {
+                attachClause(newClause(lits, true, lits.size()));
+            }
+        }
+        return true;
+    }
+
+    void exportClause(const vector<Lit>& learnt, uint32_t lbd) {
+        if (!export_clause) return;
+        export_buffer.clear();
+        for (Lit l : learnt) export_buffer.push_back((l & 1) ? -(var(l) + 1) : var(l) + 1);
+        if (export_clause(export_buffer, lbd)) stats_.exported++;
+    }
+
+    int pickBranchVariable() {
+        if (config.random_var_freq > 0 && !heap.empty() &&
+            nextRandom() % 1000000 < config.random_var_freq * 1000000) {
+            int v = heap[nextRandom() % heap.size()];
+            if (assigns[v] == 0) return v;
+        }
+        while (!heap.empty()) {
+            int v = heapPop();
+            if (assigns[v] == 0) return v;
+        }
+        return -1;
+    }
 
-    if (root->data == "~") {
-        Node* child = root->left;
-        
-        if (child->data == "~") { // Double Negation: ~(~A) -> A
-            Node* grandchild = child->left;
-            child->left = nullptr;
-            delete root;
-            delete child;
-            return nnf(grandchild);
+    SatResult search() {
+        if (!ok || !importClauses() || propagate() != NO_REASON) {
+            ok = false;
+            return SatResult::UNSAT;
         }
-        
-        // De Morgan's Law
-        if (child->data == "+") { // ~(A + B) -> ~A * ~B
-            Node* new_and = new Node("*");
-            Node* notA = new Node("~");
-            Node* notB = new Node("~");
-
-            notA->left = child->left; 
-            notB->left = child->right;
-            
-            child->left = nullptr; 
-            child->right = nullptr;
 
-            new_and->left = nnf(notA);
-            new_and->right = nnf(notB);
+        vector<Lit> learnt;
+        while (true) {
+            if (cancelled()) return SatResult::UNKNOWN;
+            CRef conflict = propagate();
+            if (conflict != NO_REASON) {
+                stats_.conflicts++;
+                conflicts_since_restart++;
+                if (decisionLevel() == 0) {
+                    ok = false;
+                    return SatResult::UNSAT;
+                }
 
-            delete root;
-            delete child;
-            return new_and;
-        }
-        if (child->data == "*") { // ~(A * B) -> ~A + ~B
-            Node* new_or = new Node("+");
-            Node* notA = new Node("~");
-            Node* notB = new Node("~");
-            
-            notA->left = child->left; 
-            notB->left = child->right;
+                uint32_t lbd;
+                int backjump = analyze(conflict, learnt, lbd);
+                cancelUntil(backjump);
+                if (learnt.size() == 1) {
+                    enqueue(learnt[0], NO_REASON);
+                } else {
+                    CRef cr = newClause(learnt, true, lbd);
+                    attachClause(cr);
+                    bumpClause(clauses[cr]);
+                    enqueue(learnt[0], cr);
+                }
+                stats_.learned++;
+                exportClause(learnt, lbd);
 
-            child->left = nullptr; 
-            child->right = nullptr;
+                var_inc /= config.var_decay;
+                clause_inc /= config.clause_decay;
+                if (stats_.conflicts == 1) lbd_fast = lbd_slow = lbd;
+                lbd_fast += (lbd - lbd_fast) / 32.0;
+                lbd_slow += (lbd - lbd_slow) / 4096.0;
+                continue;
+            }
 
-            new_or->left = nnf(notA);
-            new_or->right = nnf(notB);
+            if (shouldRestart()) {
+                cancelUntil(0);
+                stats_.restarts++;
+                conflicts_since_restart = 0;
+                if (!importClauses()) {
+                    ok = false;
+                    return SatResult::UNSAT;
+                }
+                continue;
+            }
+            if (stats_.conflicts >= next_reduce) {
+                next_reduce += config.first_reduce + config.reduce_increment * ++reductions;
+                reduceDB();
+            }
 
-            delete root;
-            delete child;
-            return new_or;
+            // Assumptions are the first decisions; one already true still
+            // gets its own (empty) level so levels and assumptions line up.
+            Lit next = 0;
+            bool have_next = false;
+            while (!have_next && decisionLevel() < (int)assumed.size()) {
+                Lit a = assumed[decisionLevel()];
+                if (value(a) > 0) trail_lim.push_back(trail.size());
+                else if (value(a) < 0) return SatResult::UNSAT;
+                else {
+                    next = a;
+                    have_next = true;
+                }
+            }
+            if (!have_next) {
+                int v = pickBranchVariable();
+                if (v < 0) return SatResult::SAT;
+                next = 2 * v + polarity[v];
+            }
+            stats_.decisions++;
+            trail_lim.push_back(trail.size());
+            enqueue(next, NO_REASON);
         }
     }
-    
-    // Recursive Case for +, * (and > which should be eliminated)
-    root->left = nnf(root->left);
-    root->right = nnf(root->right);
-    return root;
-}
 
-Node* copyTree(Node* root) {
-    if (!root) return nullptr;
-    Node* newNode = new Node(root->data);
-    newNode->left = copyTree(root->left);
-    newNode->right = copyTree(root->right);
-    return newNode;
-}
+    CdclConfig config;
+    int num_vars;
+    bool ok = true;
 
-Node* cnf(Node* root) {
-    if (!root) return nullptr;
-    if (isOperand(root->data) || root->data == "~") return root;
+    vector<int> assigns;
+    vector<int> level;
+    vector<CRef> reason;
+    vector<char> polarity;
+    vector<char> seen;
+    vector<double> activity;
+    vector<int> heap;
+    vector<int> heap_index;
+    vector<uint64_t> level_stamp;
+    uint64_t stamp = 0;
 
-    root->left = cnf(root->left);
-    root->right = cnf(root->right);
+    vector<SolverClause> clauses;
+    vector<Lit> arena;
+    size_t wasted = 0; // Arena literals of removed clauses
+    vector<CRef> learnts;
+    vector<CRef> free_slots;
+    vector<vector<Watch>> watches;
 
-    if (root->data == "+") {
-        // Distributive Law: (A * B) + C -> (A + C) * (B + C)
-        if (root->left && root->left->data == "*") {
-            Node* l = root->left;
-            Node* r = root->right;
-            
-            Node* p = l->left;
-            Node* q = l->right;
+    vector<Lit> trail;
+    vector<size_t> trail_lim;
+    size_t qhead = 0;
+
+    vector<Lit> analyze_stack;
+    vector<Lit> analyze_toclear;
 
-            Node* new_and = new Node("*");
+    double var_inc = 1.0;
+    double clause_inc = 1.0;
+    double lbd_fast = 0;
+    double lbd_slow = 0;
+    uint64_t conflicts_since_restart = 0;
+    uint64_t reductions = 0;
+    uint64_t next_reduce;
+    uint32_t rng_state;
+    vector<Lit> assumed;
+    CdclStats stats_;
 
-            Node* p_plus_r = new Node("+");
-            p_plus_r->left = p;
-            p_plus_r->right = r;
+    const atomic<bool>* cancel = nullptr;
+    ExportFn export_clause;
+    ImportFn import_clauses;
+    vector<Literal> export_buffer;
+    vector<vector<Literal>> imported_buffer;
+};
 
-            Node* q_plus_r_copy = new Node("+");
-            q_plus_r_copy->left = copyTree(q); // Fix: need to copy Q here as P is detached
-            q_plus_r_copy->right = copyTree(r); 
+SatResult solveCDCL(CnfView formula, int numVars, vector<char>& model) {
+    CDCLSolver solver(formula, numVars);
+    return solver.solve(model);
+}
 
-            // Detach children before deletion to prevent double-delete
-            l->left = nullptr;
-            l->right = nullptr;
-            root->right = nullptr;
+// Solver counters as DIMACS comment lines, including throughput.
+void printCdclStats(const CdclStats& s) {
+    double secs = max(s.seconds, 1e-9);
+    cout << "c conflicts:    " << s.conflicts << " (" << (uint64_t)(s.conflicts / secs) << "/s)" << endl;
+    cout << "c propagations: " << s.propagations << " (" << (uint64_t)(s.propagations / secs) << "/s)" << endl;
+    cout << "c decisions:    " << s.decisions << endl;
+    cout << "c restarts:     " << s.restarts << endl;
+    cout << "c learned:      " << s.learned << " (deleted " << s.deleted << ")" << endl;
+    if (s.exported || s.imported) {
+        cout << "c exchanged:    " << s.exported << " exported, " << s.imported << " imported" << endl;
+    }
+    cout << "c solve time:   " << s.seconds * 1000 << " ms" << endl;
+}
 
-            delete l;
-            delete root;
+// --- Parallel Portfolio ---
+// Lossy multi-producer broadcast ring for short learned clauses. A writer
+// claims a slot by moving its sequence number from even to odd with a CAS
+// and publishes it with the next even value; if the slot is busy the clause
+// is dropped. Readers copy a slot and keep it only if the sequence number
+// was even and unchanged around the copy (a seqlock), so nobody ever blocks.
+class ClauseExchange {
+public:
+    static const size_t kSlots = 4096;
+    static const size_t kMaxLits = 8;
 
-            new_and->left = cnf(p_plus_r);
-            new_and->right = cnf(q_plus_r_copy); 
+    void publish(unsigned producer, const vector<Literal>& clause) {
+        if (clause.size() > kMaxLits) return;
+        uint64_t position = head.fetch_add(1, memory_order_relaxed);
+        Slot& slot = slots[position % kSlots];
+        uint32_t seq = slot.seq.load(memory_order_relaxed);
+        if ((seq & 1) || !slot.seq.compare_exchange_strong(seq, seq + 1, memory_order_acquire)) return;
+        slot.position.store(position, memory_order_relaxed);
+        slot.producer.store(producer, memory_order_relaxed);
+        slot.size.store(clause.size(), memory_order_relaxed);
+        for (size_t i = 0; i < clause.size(); ++i) slot.lits[i].store(clause[i], memory_order_relaxed);
+        slot.seq.store(seq + 2, memory_order_release);
+    }
 
-            return new_and;
+    // Appends clauses published since *cursor by other producers.
+    void collect(unsigned reader, uint64_t& cursor, vector<vector<Literal>>& out) const {
+        uint64_t end = head.load(memory_order_acquire);
+        if (end - cursor > kSlots) cursor = end - kSlots; // Older entries were overwritten
+        vector<Literal> clause;
+        for (; cursor < end; ++cursor) {
+            const Slot& slot = slots[cursor % kSlots];
+            uint32_t before = slot.seq.load(memory_order_acquire);
+            if (before & 1) continue;
+            uint64_t position = slot.position.load(memory_order_relaxed);
+            unsigned producer = slot.producer.load(memory_order_relaxed);
+            uint32_t size = min<uint32_t>(slot.size.load(memory_order_relaxed), kMaxLits);
+            clause.resize(size);
+            for (uint32_t i = 0; i < size; ++i) clause[i] = slot.lits[i].load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if (slot.seq.load(memory_order_relaxed) != before) continue;
+            if (position != cursor || producer == reader) continue;
+            out.push_back(clause);
         }
-        // Distributive Law: C + (A * B) -> (C + A) * (C + B)
-        if (root->right && root->right->data == "*") {
-            Node* l = root->left;
-            Node* r = root->right;
+    }
 
-            Node* p = l;
-            Node* q = r->left;
-            Node* s = r->right; 
+private:
+    struct Slot {
+        atomic<uint32_t> seq{0};
+        atomic<uint64_t> position{~0ull};
+        atomic<unsigned> producer{0};
+        atomic<uint32_t> size{0};
+        atomic<Literal> lits[kMaxLits];
+    };
 
-            Node* new_and = new Node("*");
+    atomic<uint64_t> head{0};
+    Slot slots[kSlots];
+};
 
-            Node* p_copy_plus_q = new Node("+");
-            p_copy_plus_q->left = copyTree(p);
-            p_copy_plus_q->right = q;
+// Diversified settings for portfolio member i; member 0 is the default.
+CdclConfig portfolioConfig(unsigned i) {
+    static const double decays[] = {0.95, 0.92, 0.97, 0.85};
+    CdclConfig config;
+    if (i == 0) return config;
+    config.restarts = (i % 2) ? CdclConfig::LUBY : CdclConfig::GLUCOSE;
+    config.initial_phase = (i / 2) % 2;
+    config.var_decay = decays[i % 4];
+    config.seed = i;
+    config.random_var_freq = (i % 3 == 2) ? 0.02 : 0;
+    return config;
+}
 
-            Node* p_plus_s = new Node("+");
-            p_plus_s->left = p;
-            p_plus_s->right = s;
-            
-            // Detach children
-            root->left = nullptr;
-            r->left = nullptr;
-            r->right = nullptr;
+struct PortfolioReport {
+    unsigned solvers = 0;
+    unsigned winner = 0;
+    CdclStats stats;       // Winner's counters
+    uint64_t shared = 0;   // Clauses offered to the exchange by all members
+};
 
-            delete r;
-            delete root;
+// Runs `threads` differently configured CDCL solvers on the same formula
+// and returns the first answer; the others are cancelled cooperatively.
+// Learned clauses with at most ClauseExchange::kMaxLits literals and
+// LBD <= 8 are shared and imported by the other members on restart.
+SatResult solvePortfolio(CnfView formula, int numVars, vector<char>& model,
+                         PortfolioReport& report, unsigned threads = threadCount) {
+    threads = max(1u, threads);
+    auto exchange = make_unique<ClauseExchange>();
+    atomic<bool> done{false};
+    atomic<uint64_t> shared{0};
+    SatResult result = SatResult::UNKNOWN;
+    report = PortfolioReport();
+    report.solvers = threads;
 
-            new_and->left = cnf(p_copy_plus_q);
-            new_and->right = cnf(p_plus_s);
-            
-            return new_and;
+    auto member = [&](unsigned id) {
+        CDCLSolver solver(formula, numVars, portfolioConfig(id));
+        uint64_t cursor = 0;
+        solver.setCancelFlag(&done);
+        if (threads > 1) {
+            solver.setClauseExport([&, id](const vector<Literal>& clause, uint32_t lbd) {
+                if (clause.size() > ClauseExchange::kMaxLits || lbd > 8) return false;
+                exchange->publish(id, clause);
+                shared.fetch_add(1, memory_order_relaxed);
+                return true;
+            });
+            solver.setClauseImport([&, id](vector<vector<Literal>>& out) {
+                exchange->collect(id, cursor, out);
+            });
         }
-    }
-    return root;
-}
-
-void printInfixFromTree(Node* root) {
-    if (root == nullptr) return;
-    if (isOperand(root->data)) {
-        cout << root->data;
-        return;
-    }
-    if (root->data == "~") {
-        cout << "~";
-        // Check if negation target needs parenthesis
-        if(root->left && (root->left->data == "+" || root->left->data == "*" || root->left->data == ">" || root->left->data == "~")) {
-             cout << "(";
-             printInfixFromTree(root->left);
-             cout << ")";
-        } else {
-             printInfixFromTree(root->left);
+        vector<char> local;
+        SatResult r = solver.solve(local);
+        bool expected = false;
+        if (r != SatResult::UNKNOWN && done.compare_exchange_strong(expected, true)) {
+            result = r;
+            model.swap(local);
+            report.winner = id;
+            report.stats = solver.stats();
         }
-        return;
-    }
-    // For binary operators, always use parenthesis in NNF/CNF display for clarity
-    cout << "(";
-    printInfixFromTree(root->left);
-    cout << " " << root->data << " ";
-    printInfixFromTree(root->right);
-    cout << ")";
+    };
+
+    vector<thread> workers;
+    for (unsigned id = 1; id < threads; ++id) workers.emplace_back(member, id);
+    member(0);
+    for (auto& worker : workers) worker.join();
+    report.shared = shared.load();
+    return result;
 }
 
-bool check_cnf_valid(const string& cnf_formula) {
-    string formula = cnf_formula;
-    
-    size_t start = 0;
-    size_t end = formula.find(" * ");
+void printPortfolioReport(const PortfolioReport& report) {
+    cout << "c portfolio:    " << report.solvers << " solvers, winner #" << report.winner
+         << ", " << report.shared << " clauses shared" << endl;
+    printCdclStats(report.stats);
+}
 
-    while(start < formula.length()) {
-        string clause_str = formula.substr(start, end - start);
-        if(clause_str.empty()) {
-             if(end == string::npos) break;
-             start = end + 3; 
-             end = formula.find(" * ", start);
-             continue;
+// --- Cube and Conquer ---
+// A lookahead splitter cuts the search space into cubes (partial
+// assignments); CDCL workers then solve the cubes as assumptions from the
+// work-stealing queue, stopping everyone as soon as one cube is SAT.
+class CubeSplitter {
+public:
+    CubeSplitter(CnfView formula, int numVars, int maxDepth, size_t candidates = 32)
+        : probe(formula, numVars), max_depth(maxDepth), candidate_limit(candidates) {
+        int n = maxVariable(formula, numVars);
+        vector<size_t> occurrences(n + 1, 0);
+        for (const auto& clause : formula) {
+            for (Literal lit : clause) occurrences[abs(lit)]++;
         }
-        
-        // Remove surrounding parentheses for the clause
-        if(clause_str.front() == '(' && clause_str.back() == ')') {
-            clause_str = clause_str.substr(1, clause_str.length() - 2);
+        for (int v = 1; v <= n; ++v) {
+            if (occurrences[v] > 0) order.push_back(v);
         }
+        stable_sort(order.begin(), order.end(), [&](int a, int b) { return occurrences[a] > occurrences[b]; });
+    }
 
-        vector<string> tokens = tokenize(clause_str);
-        set<string> literals;
-        set<string> negated_literals;
+    // Cubes covering every assignment the lookahead could not refute; an
+    // empty result means the formula is UNSAT.
+    vector<vector<Literal>> split() {
+        cubes.clear();
+        vector<Literal> cube;
+        if (probe.consistent()) split_helper(cube, 0);
+        return cubes;
+    }
 
-        for (size_t i = 0; i < tokens.size(); ++i) {
-            if (tokens[i] == "~") {
-                if (i + 1 < tokens.size() && isOperand(tokens[i+1])) {
-                    negated_literals.insert(tokens[i+1]);
-                    i++; // Skip the literal itself
-                }
-            } else if (isOperand(tokens[i])) {
-                literals.insert(tokens[i]);
+private:
+    // Lookahead score for branching on v: both sides should propagate a lot,
+    // so the product of implied literal counts is maximised. Sets `failed`
+    // to a literal whose assignment conflicts (0 if none).
+    bool chooseVariable(int& best, Literal& failed) {
+        best = 0;
+        failed = 0;
+        double best_score = -1;
+        size_t considered = 0;
+        for (int v : order) {
+            if (considered == candidate_limit) break;
+            if (probe.literalValue(v) != 0) continue;
+            considered++;
+            size_t pos = 0, neg = 0;
+            bool pos_ok = probe.assume(v, pos);
+            if (pos_ok) probe.undoAssume();
+            bool neg_ok = probe.assume(-v, neg);
+            if (neg_ok) probe.undoAssume();
+            if (!pos_ok || !neg_ok) {
+                failed = pos_ok ? -v : v;
+                return neg_ok || pos_ok;
+            }
+            double score = (double)(pos + 1) * (neg + 1);
+            if (score > best_score) {
+                best_score = score;
+                best = v;
             }
         }
-        
-        bool has_complement = false;
-        for(const string& lit : literals) {
-            if(negated_literals.count(lit)) {
-                has_complement = true;
+        return true;
+    }
+
+    void split_helper(vector<Literal>& cube, int depth) {
+        size_t forced = 0;
+        int best;
+        Literal failed;
+        while (true) {
+            if (!chooseVariable(best, failed)) break; // Both sides conflict: refuted
+            if (failed == 0) {
+                if (best == 0 || depth == max_depth) {
+                    cubes.push_back(cube);
+                } else {
+                    for (Literal lit : {best, -best}) {
+                        size_t implied;
+                        if (!probe.assume(lit, implied)) continue;
+                        cube.push_back(lit);
+                        split_helper(cube, depth + 1);
+                        cube.pop_back();
+                        probe.undoAssume();
+                    }
+                }
                 break;
             }
+            // Failed literal: its complement is implied by the cube.
+            size_t implied;
+            if (!probe.assume(-failed, implied)) break;
+            cube.push_back(-failed);
+            forced++;
         }
-        
-        // A CNF formula is valid (a tautology) IFF all its clauses are tautologies.
-        // A clause is a tautology IFF it contains a complementary pair (A + ~A).
-        if(!has_complement) {
-            return false; 
+        for (; forced > 0; --forced) {
+            cube.pop_back();
+            probe.undoAssume();
         }
-
-        if(end == string::npos) break;
-        start = end + 3; 
-        end = formula.find(" * ", start);
     }
 
-    return true; 
-}
+    CDCLSolver probe;
+    int max_depth;
+    size_t candidate_limit;
+    vector<int> order;
+    vector<vector<Literal>> cubes;
+};
 
-DimacsCNF readDIMACSCNF(const string& dimacsInput, int& numVars, int& numClauses) {
-    DimacsCNF formula;
-    stringstream ss(dimacsInput);
-    string line;
-    numVars = 0;
-    numClauses = 0;
-    bool p_line_found = false;
+struct CubeReport {
+    size_t cubes = 0;
+    size_t solved = 0;         // Cubes finished before the search stopped
+    double split_seconds = 0;
+    CdclStats stats;           // Summed over workers; seconds is wall time
+};
 
-    while (getline(ss, line)) {
-        if (line.empty() || line[0] == 'c') continue; 
-        
-        if (line[0] == 'p') {
-            stringstream ps(line.substr(1));
-            string type;
-            if (!(ps >> type >> numVars >> numClauses) || type != "cnf") {
-                cerr << "Error: Invalid or missing 'p cnf' line." << endl;
-                return {};
-            }
-            p_line_found = true;
-            continue;
-        }
-        
-        if (!p_line_found) continue;
+// Splits to `depth` levels (default: enough for ~32 cubes per thread) and
+// conquers the cubes in parallel. Each worker keeps one CDCLSolver across its
+// cubes, so clauses learned on one cube help with the next.
+SatResult solveCubeAndConquer(CnfView formula, int numVars, vector<char>& model,
+                              CubeReport& report, unsigned threads = threadCount, int depth = -1) {
+    threads = max(1u, threads);
+    if (depth < 0) depth = (int)ceil(log2((double)threads)) + 5;
+    report = CubeReport();
 
-        stringstream cs(line);
-        Literal lit;
-        Clause currentClause;
-        bool clause_ended = true;
+    auto start = chrono::high_resolution_clock::now();
+    vector<vector<Literal>> cubes = CubeSplitter(formula, numVars, depth).split();
+    auto split_end = chrono::high_resolution_clock::now();
+    report.split_seconds = chrono::duration<double>(split_end - start).count();
+    report.cubes = cubes.size();
+    if (cubes.empty()) return SatResult::UNSAT;
 
-        while (cs >> lit) {
-            if (lit == 0) {
-                if (!currentClause.empty() || clause_ended == false) {
-                     formula.push_back(currentClause);
-                }
-                currentClause.clear();
-                clause_ended = true;
-            } else {
-                currentClause.push_back(lit);
-                clause_ended = false;
-            }
-        }
-    }
-    return formula;
-}
+    atomic<bool> done{false};
+    atomic<bool> refuted{false};  // A worker proved UNSAT without assumptions
+    atomic<size_t> unsat_cubes{0};
+    atomic<size_t> solved{0};
+    SatResult result = SatResult::UNKNOWN;
+    vector<unique_ptr<CDCLSolver>> solvers(threads);
 
-bool is_dimacs_clause_true(const Clause& clause) {
-    set<int> positiveLits;
-    for (Literal lit : clause) {
-        if (lit > 0) {
-            positiveLits.insert(lit);
+    parallelForChunks(cubes.size(), 1, threads, [&](uint64_t first, uint64_t, unsigned worker) {
+        if (done.load(memory_order_relaxed)) return;
+        unique_ptr<CDCLSolver>& solver = solvers[worker];
+        if (!solver) {
+            solver = make_unique<CDCLSolver>(formula, numVars);
+            solver->setCancelFlag(&done);
         }
-    }
-    for (Literal lit : clause) {
-        if (lit < 0) {
-            if (positiveLits.count(-lit)) {
-                return true; // Clause contains a complementary pair (tautology)
-            }
+        vector<char> local;
+        SatResult r = solver->solve(local, cubes[first]);
+        if (r == SatResult::UNKNOWN) return;
+        solved++;
+        bool expected = false;
+        if (r == SatResult::SAT && done.compare_exchange_strong(expected, true)) {
+            result = SatResult::SAT;
+            model.swap(local);
+        } else if (r == SatResult::UNSAT) {
+            unsat_cubes++;
+            if (!solver->consistent() && !refuted.exchange(true)) done = true;
         }
+    });
+
+    for (const auto& solver : solvers) {
+        if (!solver) continue;
+        const CdclStats& s = solver->stats();
+        report.stats.conflicts += s.conflicts;
+        report.stats.decisions += s.decisions;
+        report.stats.propagations += s.propagations;
+        report.stats.restarts += s.restarts;
+        report.stats.learned += s.learned;
+        report.stats.deleted += s.deleted;
     }
-    return false;
+    report.stats.seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - split_end).count();
+    report.solved = solved;
+    if (result != SatResult::SAT && (refuted || unsat_cubes == cubes.size())) result = SatResult::UNSAT;
+    return result;
+}
+
+void printCubeReport(const CubeReport& report) {
+    cout << "c cubes:        " << report.cubes << " (" << report.solved << " solved), split in "
+         << report.split_seconds * 1000 << " ms" << endl;
+    printCdclStats(report.stats);
 }
 
-bool check_dimacs_valid_formula(const DimacsCNF& formula) {
-    int count_false = 0;
-    for (const auto& cls : formula) {
-        if (!is_dimacs_clause_true(cls)) {
-            count_false++;
+// --- Validity Checking ---
+// Buffers solveFormula() fills for each formula. A caller that checks many
+// formulas (the batch `valid` command) passes the same object every time,
+// so the clause database and model keep their capacity. The Tseitin
+// encoder and CDCL solver are still built per formula: their state is sized
+// to that formula and freed when it is done, so memory stays bounded by the
+// largest formula rather than growing with the number checked.
+struct FormulaSolveBuffers {
+    DimacsCNF formula;
+    vector<string> varNames;
+    vector<char> model;
+};
+
+// Decides satisfiability of an arbitrary formula, or of its negation, by
+// handing its Plaisted-Greenbaum encoding to the CDCL solver: linear in the
+// formula size, with no truth table or CNF distribution. On SAT,
+// `assignment` holds the values of the formula's own variables.
+SatResult solveFormula(Node* root, bool negate, vector<pair<string, bool>>& assignment,
+                       FormulaSolveBuffers& buffers) {
+    assignment.clear();
+    DimacsCNF& formula = buffers.formula;
+    formula.clear();
+    TseitinEncoder encoder(root, formula, buffers.varNames, true);
+    Literal top = encoder.encode(root, negate ? NEGATIVE : POSITIVE);
+    formula.push_back({negate ? -top : top});
+
+    CDCLSolver solver(formula, encoder.numVars());
+    SatResult result = solver.solve(buffers.model);
+    if (result == SatResult::SAT) {
+        for (size_t i = 0; i < buffers.varNames.size(); ++i) {
+            assignment.push_back({buffers.varNames[i], buffers.model[i + 1] != 0});
         }
     }
-    cout << "Number of non-tautology clauses: " << count_false << endl;
-    cout << "Number of tautology clauses: " << formula.size() - count_false << endl;
-    return count_false == 0; 
+    return result;
 }
 
-string dimacsToInfix(const DimacsCNF& formula) {
-    if (formula.empty()) return "";
+SatResult solveFormula(Node* root, bool negate, vector<pair<string, bool>>& assignment) {
+    FormulaSolveBuffers buffers;
+    return solveFormula(root, negate, assignment, buffers);
+}
 
-    stringstream infix_ss;
-    for (size_t i = 0; i < formula.size(); ++i) {
-        const auto& clause = formula[i];
-        if (clause.empty()) continue;
+// F is valid iff ~F is unsatisfiable; otherwise a model of ~F is a
+// counterexample (an assignment that makes F false).
+bool isValid(Node* root, vector<pair<string, bool>>& counterexample, FormulaSolveBuffers& buffers) {
+    return solveFormula(root, true, counterexample, buffers) == SatResult::UNSAT;
+}
 
-        infix_ss << "(";
-        for (size_t j = 0; j < clause.size(); ++j) {
-            Literal lit = clause[j];
-            
-            // P-notation is used for variables (P1, P2, ...)
-            if (lit < 0) {
-                infix_ss << "~P" << -lit;
-            } else {
-                infix_ss << "P" << lit;
-            }
-            if (j < clause.size() - 1) {
-                infix_ss << " + ";
-            }
-        }
-        infix_ss << ")";
+bool isValid(Node* root, vector<pair<string, bool>>& counterexample) {
+    FormulaSolveBuffers buffers;
+    return isValid(root, counterexample, buffers);
+}
 
-        if (i < formula.size() - 1) {
-            infix_ss << " * ";
+void printAssignment(const vector<pair<string, bool>>& assignment) {
+    for (size_t i = 0; i < assignment.size(); ++i) {
+        cout << (i ? ", " : "") << assignment[i].first << " = " << (assignment[i].second ? "T" : "F");
+    }
+    cout << endl;
+}
+
+// Validity and satisfiability of a formula, classified like the truth-table
+// summary (tautology / contradiction / contingent).
+void printValidityReport(Node* root) {
+    if (!root) {
+        cout << "Error: Empty formula." << endl;
+        return;
+    }
+    auto start = chrono::high_resolution_clock::now();
+    vector<pair<string, bool>> counterexample, model;
+    bool valid = isValid(root, counterexample);
+    bool satisfiable = valid || solveFormula(root, false, model) == SatResult::SAT;
+    auto end = chrono::high_resolution_clock::now();
+
+    if (valid) {
+        cout << "Valid: the formula is a tautology." << endl;
+    } else {
+        cout << "NOT valid. Counterexample: ";
+        printAssignment(counterexample);
+        if (satisfiable) {
+            cout << "Satisfiable (contingent). Model: ";
+            printAssignment(model);
+        } else {
+            cout << "Unsatisfiable: the formula is a contradiction." << endl;
         }
     }
-    return infix_ss.str();
+    cout << "Decided in " << chrono::duration<double, milli>(end - start).count() << " ms" << endl;
 }
 
 string getExpressionFromInput(string requiredFormat) { 
@@ -619,14 +3940,9 @@ string getExpressionFromInput(string requiredFormat) {
         getline(cin, expression);
         return expression;
     } else { 
-        cout << "\nEnter DIMACS CNF input (paste lines, finish with a blank line): \n";
-        string dimacsInput, line;
-        while (getline(cin, line) && !line.empty()) {
-            dimacsInput += line + "\n";
-        }
-        
         int numVars, numClauses;
-        DimacsCNF formula = readDIMACSCNF(dimacsInput, numVars, numClauses);
+        DimacsCNF formula;
+        if (!readDIMACSFromUser(formula, numVars, numClauses)) return "";
         string infix_expr = dimacsToInfix(formula);
         
         cout << "Generated infix from DIMACS: " << infix_expr << endl;
@@ -657,17 +3973,17 @@ void run_automated_case(int case_num, const string& title, const string& input_d
             Node* root = buildParseTree(prefix_copy);
             cout << "Generated Parse Tree:\n";
             printTree(root);
-            deleteTree(root);
+            releaseTree();
         } else if (case_num == 3) { // Tree to Infix - Not used in workflow
             string prefix_copy = input_data;
             Node* root = buildParseTree(prefix_copy);
             cout << "Result Infix: " << parseTreeToInfix(root) << endl;
-            deleteTree(root);
+            releaseTree();
         } else if (case_num == 4) { // Tree Height
             string prefix_copy = input_data;
             Node* root = buildParseTree(prefix_copy);
             cout << "Tree Height: " << getTreeHeight(root) << endl;
-            deleteTree(root);
+            releaseTree();
         } else if (case_num == 5) { // Truth Table
             string prefix = infixToPrefix(input_data);
             Node* root = buildParseTree(prefix);
@@ -680,31 +3996,12 @@ void run_automated_case(int case_num, const string& title, const string& input_d
 
             if (n > 5) {
                 cout << "Formula has too many variables (" << n << ") for quick truth table generation. Skipping table." << endl;
-                deleteTree(root);
+                releaseTree();
                 return;
             }
             
-            for (const string& v : varList) {
-                cout << v << "\t";
-            }
-            cout << "Result" << endl;
-
-            long long row_count = 1LL << n; 
-
-            for (long long i = 0; i < row_count; ++i) {
-                unordered_map<string, bool> rowValues;
-                for (int j = 0; j < n; ++j) {
-                    bool val = (i >> (n - 1 - j)) & 1;
-                    rowValues[varList[j]] = val;
-                    cout << (val ? "T" : "F") << "\t";
-                }
-                try {
-                    cout << (evaluate(root, rowValues) ? "T" : "F") << endl;
-                } catch(const runtime_error& e) {
-                     cout << "ERROR" << endl;
-                }
-            }
-            deleteTree(root);
+            printTruthTable(root, varList);
+            releaseTree();
         } else if (case_num == 6) { // CNF Conversion
             string prefix = infixToPrefix(input_data);
             Node* root = buildParseTree(prefix);
@@ -726,12 +4023,12 @@ void run_automated_case(int case_num, const string& title, const string& input_d
             printInfixFromTree(final_cnf_root);
             cout << endl;
             
-            deleteTree(final_cnf_root);
+            releaseTree();
         } else if (case_num == 7) { // Check CNF Validity (Infix)
-            bool valid = check_cnf_valid(input_data);
-            if (valid)
+            CnfValidity validity = check_cnf_valid(input_data);
+            if (validity == CnfValidity::VALID)
                 cout << "Validity Check: The CNF formula is valid (a tautology)." << endl;
-            else
+            else if (validity == CnfValidity::NOT_VALID)
                 cout << "Validity Check: The CNF formula is NOT valid (not a tautology)." << endl;
         } else if (case_num == 8) { // Check CNF Validity (DIMACS)
             int numVars, numClauses;
@@ -749,6 +4046,22 @@ void run_automated_case(int case_num, const string& title, const string& input_d
             int numVars, numClauses;
             DimacsCNF formula = readDIMACSCNF(input_data, numVars, numClauses);
             cout << "Generated Infix String: " << dimacsToInfix(formula) << endl;
+        } else if (case_num == 10) { // Tseitin CNF
+            string prefix = infixToPrefix(input_data);
+            Node* root = buildParseTree(prefix);
+            int numVars;
+            vector<string> varNames;
+            DimacsCNF formula = tseitinCNF(root, numVars, varNames);
+            cout << "Tseitin CNF (" << varNames.size() << " input + " << numVars - (int)varNames.size()
+                 << " auxiliary variables, " << formula.size() << " clauses):" << endl;
+            cout << dimacsToString(formula, numVars, varNames);
+            printEncodingStats(root);
+            releaseTree();
+        } else if (case_num == 14) { // Validity / satisfiability via Tseitin + CDCL
+            string prefix = infixToPrefix(input_data);
+            Node* root = buildParseTree(prefix);
+            printValidityReport(root);
+            releaseTree();
         }
     } catch (const exception& e) {
         cout << "An ERROR occurred during analysis: " << e.what() << endl;
@@ -790,15 +4103,9 @@ void run_automated_workflow() {
         cout << "\nInput received (Infix): " << final_infix << endl;
     } else { // Choice == 2
         // DIMACS CNF input
-        cout << "\nEnter DIMACS CNF input (paste lines, finish with a blank line): \n";
-        string line;
-        while (getline(cin, line) && !line.empty()) {
-            input_data_raw += line + "\n";
-        }
-        
         int numVars, numClauses;
-        DimacsCNF formula = readDIMACSCNF(input_data_raw, numVars, numClauses);
-        final_infix = dimacsToInfix(formula);
+        DimacsCNF formula;
+        if (readDIMACSFromUser(formula, numVars, numClauses)) final_infix = dimacsToInfix(formula);
         
         cout << "\nInput received (DIMACS). Converted to Infix: " << final_infix << endl;
     }
@@ -828,6 +4135,12 @@ void run_automated_workflow() {
     // D. CNF Conversion
     run_automated_case(6, "ANALYSIS D: Full CNF Conversion (Impl-Free, NNF, CNF)", final_infix);
 
+    // E. Linear-size CNF
+    run_automated_case(10, "ANALYSIS E: Tseitin CNF Encoding (DIMACS)", final_infix);
+
+    // F. Validity without truth tables
+    run_automated_case(14, "ANALYSIS F: Validity Check (Tseitin + CDCL, counterexample)", final_infix);
+
     cout << "\n==========================================================================" << endl;
     cout << "USER-DRIVEN WORKFLOW COMPLETE." << endl;
     cout << "==========================================================================" << endl;
@@ -846,13 +4159,281 @@ void showMenu() {
     cout << "7. Check Validity of a CNF Formula (Infix String - Tautology check)" << endl;
     cout << "8. Check Validity of CNF (DIMACS Format - Tautology check)" << endl;
     cout << "9. Convert DIMACS to Infix String" << endl;
+    cout << "10. Convert Formula to CNF (Tseitin / Plaisted-Greenbaum, DIMACS output)" << endl;
+    cout << "13. Check Satisfiability of DIMACS CNF (CDCL solver, prints a model)" << endl;
+    cout << "14. Check Validity / Satisfiability of Any Formula (Tseitin + CDCL, counterexample)" << endl;
     cout << "----------------------------------------------------------------" << endl;
     cout << "11. Run User-Driven Workflow Demonstration (New!)" << endl;
     cout << "12. Exit" << endl;
     cout << "Enter your choice: ";
 }
 
-int main() {
+// --- Batch Commands ---
+// Solver used by `sat FILE` and menu option 13 (set with --solver).
+enum class SatSolverKind { CDCL, DPLL, Portfolio, Cube };
+SatSolverKind satSolver = SatSolverKind::CDCL;
+
+const char* satSolverName(SatSolverKind kind) {
+    switch (kind) {
+        case SatSolverKind::DPLL: return "DPLL";
+        case SatSolverKind::Portfolio: return "Portfolio CDCL";
+        case SatSolverKind::Cube: return "Cube-and-Conquer";
+        default: return "CDCL";
+    }
+}
+
+// Runs the selected solver and prints the result and its statistics.
+SatResult solveWithSelectedSolver(CnfView formula, int numVars) {
+    vector<char> model;
+    SatResult result;
+    if (satSolver == SatSolverKind::DPLL) {
+        DPLLSolver solver(formula, numVars);
+        result = solver.solve(model);
+        printSatResult(result, model);
+        cout << "c decisions:    " << solver.decisionCount() << endl;
+        cout << "c propagations: " << solver.propagationCount() << endl;
+    } else if (satSolver == SatSolverKind::Portfolio) {
+        PortfolioReport report;
+        result = solvePortfolio(formula, numVars, model, report);
+        printSatResult(result, model);
+        printPortfolioReport(report);
+    } else if (satSolver == SatSolverKind::Cube) {
+        CubeReport report;
+        result = solveCubeAndConquer(formula, numVars, model, report);
+        printSatResult(result, model);
+        printCubeReport(report);
+    } else {
+        CDCLSolver solver(formula, numVars);
+        result = solver.solve(model);
+        printSatResult(result, model);
+        printCdclStats(solver.stats());
+    }
+    return result;
+}
+
+// `sat FILE`: exit code 10 for SAT and 20 for UNSAT, as SAT solvers do.
+// Binary caches are solved straight from the mapping.
+int run_sat_command(const string& path) {
+    SatResult result;
+    MappedFile probe(path);
+    if (probe.ok() && hasCnfCacheMagic(probe.data(), probe.size())) {
+        CnfCacheFile cache(path);
+        if (!cache.ok()) {
+            cerr << "Error: '" << path << "': " << cache.error() << "." << endl;
+            return 1;
+        }
+        result = solveWithSelectedSolver(cache.view(), cache.numVars());
+    } else {
+        DimacsCNF formula;
+        int numVars, numClauses;
+        if (!readDIMACSFile(path, formula, numVars, numClauses)) return 1;
+        result = solveWithSelectedSolver(formula, numVars);
+    }
+    if (result == SatResult::UNKNOWN) return 0;
+    return result == SatResult::SAT ? 10 : 20;
+}
+
+// `cache IN OUT`: converts a DIMACS file to the binary cache format.
+int run_cache_command(const string& in, const string& out) {
+    DimacsCNF formula;
+    int numVars, numClauses;
+    auto start = chrono::high_resolution_clock::now();
+    if (!readDIMACSFile(in, formula, numVars, numClauses)) return 1;
+    if (!writeCnfCache(out, formula, numVars, numClauses)) return 1;
+    double secs = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    size_t bytes = sizeof(CnfCacheHeader) + (formula.size() + 1) * sizeof(uint64_t) +
+                   formula.literalCount() * sizeof(Literal);
+    cout << "Wrote " << formula.size() << " clauses to '" << out << "' (" << bytes / 1e6 << " MB in "
+         << secs * 1000 << " ms)." << endl;
+    return 0;
+}
+
+// True if the tokens of an infix line form one complete formula: operands
+// and operators alternate, every '(' is closed, and nothing follows the
+// last operand. infixToPrefix() and buildParseTree() are lenient (they drop
+// stray parentheses and ignore trailing tokens), so batch input is checked
+// here first instead of being answered for a different formula.
+bool isWellFormedInfix(const vector<string>& tokens) {
+    bool expect_operand = true;
+    int depth = 0;
+    for (const string& token : tokens) {
+        if (expect_operand) {
+            if (token == "(") depth++;
+            else if (token == "~") continue;
+            else if (isOperand(token)) expect_operand = false;
+            else return false;
+        } else {
+            if (token == ")") {
+                if (--depth < 0) return false;
+            } else if (isOperator(token) && token != "~") {
+                expect_operand = true;
+            } else {
+                return false;
+            }
+        }
+    }
+    return !expect_operand && depth == 0;
+}
+
+// Runs `fn` on every non-blank line of `inPath` (one infix formula per
+// line, "-" for stdin) and writes one result line per formula to `outPath`.
+// The line, result and output buffers and the node arena are reused for
+// every formula; throughput goes to stderr so stdout stays machine-readable.
+// Returns 0, or 1 if an input could not be opened or a line did not parse.
+int runFormulaBatch(const string& inPath, const string& outPath, const function<void(Node*, string&)>& fn) {
+    ifstream inFile;
+    ofstream outFile;
+    if (inPath != "-") {
+        inFile.open(inPath);
+        if (!inFile) {
+            cerr << "Error: Could not read '" << inPath << "'." << endl;
+            return 1;
+        }
+    }
+    if (outPath != "-") {
+        outFile.open(outPath, ios::binary | ios::trunc);
+        if (!outFile) {
+            cerr << "Error: Could not write '" << outPath << "'." << endl;
+            return 1;
+        }
+    }
+    istream& in = inPath == "-" ? cin : inFile;
+    uint64_t items = 0, errors = 0;
+    auto start = chrono::high_resolution_clock::now();
+    {
+        BufferedWriter out(outPath == "-" ? cout : outFile);
+        string line, result;
+        while (getline(in, line)) {
+            if (line.find_first_not_of(" \t\r") == string::npos) continue;
+            items++;
+            result.clear();
+            if (isWellFormedInfix(tokenize(line))) {
+                fn(buildParseTree(infixToPrefix(line)), result);
+            } else {
+                result = "error: malformed formula";
+                errors++;
+            }
+            // Each line is independent, so its nodes and variable names go too.
+            releaseTree();
+            symbols.clear();
+            result += '\n';
+            out.write(result);
+        }
+    }
+    double secs = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cerr << "Processed " << items << " formulas (" << errors << " errors) in " << secs * 1000 << " ms, "
+         << items / max(secs, 1e-9) << " formulas/s." << endl;
+    return errors ? 1 : 0;
+}
+
+// `cnf`: one CNF (implication-free -> NNF -> distribution) per input line.
+int run_cnf_command(const string& inPath, const string& outPath) {
+    return runFormulaBatch(inPath, outPath, [](Node* root, string& result) {
+        appendInfix(cnf(nnf(impl_free(root))), result, true);
+    });
+}
+
+// `valid` on formulas: "valid", or "invalid" followed by a counterexample.
+int run_valid_formulas_command(const string& inPath, const string& outPath) {
+    vector<pair<string, bool>> counterexample;
+    FormulaSolveBuffers buffers;
+    return runFormulaBatch(inPath, outPath, [&](Node* root, string& result) {
+        if (isValid(root, counterexample, buffers)) {
+            result = "valid";
+            return;
+        }
+        result = "invalid";
+        for (const auto& assignment : counterexample) {
+            result += ' ';
+            result += assignment.first;
+            result += assignment.second ? "=T" : "=F";
+        }
+    });
+}
+
+// `valid FILE...`: tautology check of each DIMACS file or binary cache, one
+// tab-separated result line per file. Returns 1 if any file failed to load.
+int run_valid_files_command(const vector<string>& paths) {
+    uint64_t total_clauses = 0;
+    int failed = 0;
+    auto start = chrono::high_resolution_clock::now();
+    for (const string& path : paths) {
+        int numVars, numClauses;
+        uint64_t clauses, tautologies;
+        if (!count_file_tautologies(path, numVars, numClauses, clauses, tautologies)) {
+            cout << path << "\terror" << endl;
+            failed++;
+            continue;
+        }
+        total_clauses += clauses;
+        cout << path << '\t' << (tautologies == clauses ? "valid" : "invalid") << '\t' << clauses
+             << " clauses\t" << tautologies << " tautologies" << endl;
+    }
+    double secs = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+    cerr << "Checked " << paths.size() << " files (" << total_clauses << " clauses) in " << secs * 1000
+         << " ms, " << paths.size() / max(secs, 1e-9) << " files/s, " << total_clauses / max(secs, 1e-9)
+         << " clauses/s." << endl;
+    return failed ? 1 : 0;
+}
+
+void printUsage(const char* program) {
+    cerr << "Usage: " << program << " [options]                 interactive menu" << endl;
+    cerr << "       " << program << " [options] sat FILE        solve a DIMACS CNF file or binary cache" << endl;
+    cerr << "       " << program << " cache IN OUT              convert DIMACS file IN to a binary cache OUT" << endl;
+    cerr << "       " << program << " cnf [--in F] [--out F]    CNF of each infix formula, one per line" << endl;
+    cerr << "       " << program << " valid [--in F] [--out F]  validity of each infix formula, one per line" << endl;
+    cerr << "       " << program << " valid FILE...             tautology check of DIMACS files ('-' = stdin)" << endl;
+    cerr << "Options:" << endl;
+    cerr << "  --in FILE, --out FILE  formula lines for cnf/valid (default '-': stdin/stdout)" << endl;
+    cerr << "  --threads N            worker threads for truth tables" << endl;
+    cerr << "  --solver NAME          SAT solver for 'sat' and menu option 13:" << endl;
+    cerr << "                         cdcl (default), dpll, portfolio (one CDCL per thread)," << endl;
+    cerr << "                         or cube (lookahead cubes solved on all threads)" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> command;
+    string inPath = "-", outPath = "-";
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--in" && i + 1 < argc) {
+            inPath = argv[++i];
+        } else if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threadCount = max(1, atoi(argv[++i]));
+        } else if (arg == "--solver" && i + 1 < argc) {
+            string name = argv[++i];
+            if (name == "cdcl") satSolver = SatSolverKind::CDCL;
+            else if (name == "dpll") satSolver = SatSolverKind::DPLL;
+            else if (name == "portfolio") satSolver = SatSolverKind::Portfolio;
+            else if (name == "cube") satSolver = SatSolverKind::Cube;
+            else {
+                cerr << "Unknown solver: " << name << endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            cerr << "Unknown argument: " << arg << endl;
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            command.push_back(arg);
+        }
+    }
+    if (!command.empty()) {
+        if (command[0] == "sat" && command.size() == 2) return run_sat_command(command[1]);
+        if (command[0] == "cache" && command.size() == 3) return run_cache_command(command[1], command[2]);
+        // Batch commands never prompt, so stdin and stdout can run untied and unsynced.
+        ios::sync_with_stdio(false);
+        cin.tie(nullptr);
+        if (command[0] == "cnf" && command.size() == 1) return run_cnf_command(inPath, outPath);
+        if (command[0] == "valid" && command.size() == 1) return run_valid_formulas_command(inPath, outPath);
+        if (command[0] == "valid") return run_valid_files_command(vector<string>(command.begin() + 1, command.end()));
+        printUsage(argv[0]);
+        return 1;
+    }
+
     int choice;
 
     while (true) {
@@ -876,21 +4457,21 @@ int main() {
                 Node* root = buildParseTree(expression);
                 cout << "\nGenerated Parse Tree:\n";
                 printTree(root);
-                deleteTree(root);
+                releaseTree();
                 break;
             }
             case 3: { 
                 string expression = getExpressionFromInput("prefix");
                 Node* root = buildParseTree(expression);
                 cout << "Generated Infix: " << parseTreeToInfix(root) << endl;
-                deleteTree(root);
+                releaseTree();
                 break;
             }
             case 4: { 
                 string expression = getExpressionFromInput("prefix");
                 Node* root = buildParseTree(expression);
                 cout << "Tree Height: " << getTreeHeight(root) << endl;
-                deleteTree(root);
+                releaseTree();
                 break;
             }
             case 5: { 
@@ -899,7 +4480,7 @@ int main() {
                 Node* root = buildParseTree(prefix_eval);
                 set<string> vars;
                 getVariables(root, vars);
-                unordered_map<string, bool> values;
+                vector<char> values(symbols.size(), 0);
 
                 cout << "\n--- Evaluation Mode ---" << endl;
                 if (!vars.empty()) {
@@ -908,7 +4489,7 @@ int main() {
                         char val_char;
                         cout << "  " << var << " = ";
                         cin >> val_char;
-                        values[var] = (val_char == 'T' || val_char == 't' || val_char == '1');
+                        values[symbols.intern(var)] = (val_char == 'T' || val_char == 't' || val_char == '1');
                     }
                     cin.ignore(numeric_limits<streamsize>::max(), '\n'); 
                     try {
@@ -920,53 +4501,75 @@ int main() {
 
                 if (!vars.empty()) {
                     char generate_table;
-                    cout << "\nGenerate full truth table? (Y/N): ";
+                    cout << "\nGenerate full truth table? (Y/N, G = Gray-code row order): ";
                     cin >> generate_table;
                     cin.ignore(numeric_limits<streamsize>::max(), '\n'); 
 
+                    // Gray-code order evaluates each row incrementally from the previous one.
+                    bool gray_order = (generate_table == 'G' || generate_table == 'g');
+                    if (gray_order) generate_table = 'Y';
+
                     if (generate_table == 'Y' || generate_table == 'y') {
+                        if (vars.size() > 62) {
+                            cout << "Too many variables (" << vars.size() << ") for a truth table." << endl;
+                            releaseTree();
+                            break;
+                        }
                         if (vars.size() > 10) {
                             cout << "Warning: This formula has " << vars.size() << " variables, generating 2^" << vars.size() << " rows." << endl;
-                            cout << "Are you sure you want to proceed? (Y/N): ";
+                            cout << "Print all rows (Y), summary only (S), write to a file (F), or abort (N)? ";
                             cin >> generate_table;
                             cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                            if (generate_table == 'S' || generate_table == 's') {
+                                cout << "\n--- Truth Table Summary ---" << endl;
+                                printTruthTableSummary(root, vector<string>(vars.begin(), vars.end()));
+                                releaseTree();
+                                break;
+                            }
+                            if (generate_table == 'F' || generate_table == 'f') {
+                                string path;
+                                char format;
+                                cout << "Output file path: ";
+                                getline(cin, path);
+                                cout << "Format: text (T) or packed binary, one bit per row (B)? ";
+                                cin >> format;
+                                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+                                ofstream file(path, ios::binary);
+                                if (!file) {
+                                    cout << "Error: Could not open '" << path << "' for writing." << endl;
+                                    releaseTree();
+                                    break;
+                                }
+                                vector<string> varList(vars.begin(), vars.end());
+                                uint64_t models = (format == 'B' || format == 'b')
+                                    ? writePackedTruthTable(root, varList, file)
+                                    : gray_order ? writeGrayCodeTruthTable(root, varList, file)
+                                                 : writeTruthTable(root, varList, file);
+                                cout << "Truth table written to " << path << endl;
+                                printModelSummary(models, varList.size());
+                                releaseTree();
+                                break;
+                            }
                             if (generate_table != 'Y' && generate_table != 'y') {
                                 cout << "Truth table generation aborted." << endl;
-                                deleteTree(root);
+                                releaseTree();
                                 break;
                             }
                         }
                         
                         cout << "\n--- Truth Table ---" << endl;
                         vector<string> varList(vars.begin(), vars.end());
-                        int n = varList.size();
-
-                        for (const string& v : varList) {
-                            cout << v << "\t";
-                        }
-                        cout << "Result" << endl;
-
-                        long long row_count = 1LL << n; 
-
-                        for (long long i = 0; i < row_count; ++i) {
-                            unordered_map<string, bool> rowValues;
-                            for (int j = 0; j < n; ++j) {
-                                bool val = (i >> (n - 1 - j)) & 1;
-                                rowValues[varList[j]] = val;
-                                cout << (val ? "T" : "F") << "\t";
-                            }
-                            try {
-                                cout << (evaluate(root, rowValues) ? "T" : "F") << endl;
-                            } catch (const exception& e) {
-                                cout << "ERROR" << endl; // Should not happen if vars are handled
-                            }
-                        }
+                        if (gray_order)
+                            printGrayCodeTruthTable(root, varList);
+                        else
+                            printTruthTable(root, varList);
                     }
                 } else {
                      cout << "Expression has no variables. Result: " << (evaluate(root, values) ? "True" : "False") << endl;
                 }
                 
-                deleteTree(root);
+                releaseTree();
                 break;
             }
             case 6: { 
@@ -991,27 +4594,48 @@ int main() {
                 printInfixFromTree(final_cnf_root);
                 cout << endl;
 
-                deleteTree(final_cnf_root);
+                releaseTree();
                 break;
             }
             case 7: { 
                 cout << "\n(Input must be in CNF, e.g., (A + B) * (~A + B))" << endl;
                 string expression = getExpressionFromInput("infix");
-                if (check_cnf_valid(expression))
+                CnfValidity validity = check_cnf_valid(expression);
+                if (validity == CnfValidity::VALID)
                     cout << "The CNF formula is valid (a tautology)." << endl;
-                else
+                else if (validity == CnfValidity::NOT_VALID)
                     cout << "The CNF formula is NOT valid." << endl;
                 break;
             }
             case 8: { 
-                cout << "\nEnter DIMACS CNF input (paste lines, finish with a blank line): \n";
-                string dimacsInput, line;
-                while (getline(cin, line) && !line.empty()) {
-                    dimacsInput += line + "\n";
+                string path, pasted;
+                DimacsSource source = promptDIMACSInput(path, pasted);
+                if (source == DimacsSource::UNREADABLE) break;
+                if (source == DimacsSource::FILE) {
+                    // Files are mapped and counted in parallel ranges without
+                    // storing clauses, so memory use does not grow with file size.
+                    int numVars, numClauses;
+                    uint64_t clauses, tautologies;
+                    size_t bytes;
+                    auto start = chrono::high_resolution_clock::now();
+                    bool parsed = count_file_tautologies(path, numVars, numClauses, clauses, tautologies, &bytes);
+                    double secs = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+                    if (!parsed) break;
+
+                    cout << "\n--- DIMACS Analysis (" << bytes / 1e6 << " MB, " << threadCount << " threads) ---" << endl;
+                    cout << "Header: " << numVars << " variables, " << numClauses << " clauses." << endl;
+                    cout << "Parsed " << clauses << " clauses in " << secs * 1000 << " ms." << endl;
+                    cout << "Number of non-tautology clauses: " << clauses - tautologies << endl;
+                    cout << "Number of tautology clauses: " << tautologies << endl;
+                    if (tautologies == clauses)
+                        cout << "The DIMACS CNF formula is valid (a tautology)." << endl;
+                    else
+                        cout << "The DIMACS CNF formula is NOT valid (has non-tautology clauses)." << endl;
+                    break;
                 }
-                
+
                 int numVars, numClauses;
-                DimacsCNF formula = readDIMACSCNF(dimacsInput, numVars, numClauses);
+                DimacsCNF formula = readDIMACSCNF(pasted, numVars, numClauses);
                 
                 cout << "\n--- DIMACS Analysis ---" << endl;
                 cout << "Header: " << numVars << " variables, " << numClauses << " clauses." << endl;
@@ -1026,19 +4650,64 @@ int main() {
                 break;
             }
             case 9: { 
-                cout << "\nEnter DIMACS CNF input (paste lines, finish with a blank line): \n";
-                string dimacsInput, line;
-                while (getline(cin, line) && !line.empty()) {
-                    dimacsInput += line + "\n";
-                }
-                
                 int numVars, numClauses;
-                DimacsCNF formula = readDIMACSCNF(dimacsInput, numVars, numClauses);
+                DimacsCNF formula;
+                if (!readDIMACSFromUser(formula, numVars, numClauses)) break;
                 
                 cout << "\n--- DIMACS to Infix ---" << endl;
                 cout << "Generated Infix String: " << dimacsToInfix(formula) << endl;
                 break;
             }
+            case 10: {
+                string expression = getExpressionFromInput("infix");
+                string prefix_cnf = infixToPrefix(expression);
+                Node* root = buildParseTree(prefix_cnf);
+
+                int mode;
+                cout << "\n  Choose encoding:" << endl;
+                cout << "  1. Tseitin (full equivalences)" << endl;
+                cout << "  2. Plaisted-Greenbaum (polarity-aware)" << endl;
+                cout << "  Enter choice: ";
+                while (!(cin >> mode) || (mode != 1 && mode != 2)) {
+                    cout << "Invalid input. Please enter 1 or 2." << endl;
+                    cin.clear();
+                    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+                }
+                cin.ignore(numeric_limits<streamsize>::max(), '\n');
+
+                int numVars;
+                vector<string> varNames;
+                DimacsCNF formula = (mode == 1) ? tseitinCNF(root, numVars, varNames)
+                                                : plaistedGreenbaumCNF(root, numVars, varNames);
+
+                cout << "\n--- " << (mode == 1 ? "Tseitin" : "Plaisted-Greenbaum")
+                     << " CNF (equisatisfiable, linear size) ---" << endl;
+                cout << "Input variables: " << varNames.size() << ", auxiliary variables: "
+                     << numVars - (int)varNames.size() << ", clauses: " << formula.size() << endl;
+                cout << dimacsToString(formula, numVars, varNames);
+                printEncodingStats(root);
+
+                releaseTree();
+                break;
+            }
+            case 13: {
+                int numVars, numClauses;
+                DimacsCNF formula;
+                if (!readDIMACSFromUser(formula, numVars, numClauses)) break;
+
+                cout << "Parsed " << formula.size() << " clauses." << endl;
+                cout << "\n--- " << satSolverName(satSolver) << " Satisfiability ---" << endl;
+                solveWithSelectedSolver(formula, numVars);
+                break;
+            }
+            case 14: {
+                string expression = getExpressionFromInput("infix");
+                Node* root = buildParseTree(infixToPrefix(expression));
+                cout << "\n--- Validity Check (Tseitin + CDCL) ---" << endl;
+                printValidityReport(root);
+                releaseTree();
+                break;
+            }
             case 11: {
                 run_automated_workflow();
                 break;
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Regression test for the batch commands' handling of malformed lines.
+# Usage: tests/batch_cli_test.sh ./propositional_logic
+set -u
+bin=${1:-./propositional_logic}
+fail=0
+
+check() { # check NAME EXPECTED_EXIT EXPECTED_OUTPUT ACTUAL_EXIT ACTUAL_OUTPUT
+    if [ "$4" != "$2" ] || [ "$5" != "$3" ]; then
+        echo "FAIL: $1"
+        echo "  expected (exit $2): $3"
+        echo "  actual   (exit $4): $5"
+        fail=1
+    fi
+}
+
+out=$(printf 'A B\n(A\nA)\nP +\n()\n' | "$bin" valid 2>/dev/null); rc=$?
+check "valid rejects malformed lines" 1 "error: malformed formula
+error: malformed formula
+error: malformed formula
+error: malformed formula
+error: malformed formula" "$rc" "$out"
+
+out=$(printf 'A B\n' | "$bin" cnf 2>/dev/null); rc=$?
+check "cnf rejects trailing tokens" 1 "error: malformed formula" "$rc" "$out"
+
+out=$(printf '(P > Q) * ~(Q)\n\n~~P + ~P\n' | "$bin" valid 2>/dev/null); rc=$?
+check "valid accepts well-formed lines" 0 "invalid P=F Q=T
+valid" "$rc" "$out"
+
+out=$(printf 'P > (Q * R)\n' | "$bin" cnf 2>/dev/null); rc=$?
+check "cnf converts a formula" 0 "((~P + Q) * (~P + R))" "$rc" "$out"
+
+[ $fail -eq 0 ] && echo "batch CLI tests passed"
+exit $fail